@@ -1,11 +1,17 @@
 #include <stdexcept> // For runtime_error
-#include <iomanip>   // For fixed, setprecision
 #include <string>
 #include <vector>
 #include <atomic>          // For unique ID generation
+#include <mutex>           // For per-account locking
+#include <functional>      // For less<>
 #include <ostream>         // For ostream
 #include "Transaction.cpp" // For Transaction class
+#include "TransactionJournal.cpp" // For the shared transaction store
 #include "DataManager.cpp" // For logging
+#include "IdSequence.cpp"  // For unique ID generation
+#include "WriteAheadLog.cpp" // For durable operation records
+#include "BalanceAggregates.cpp" // For the bank's running totals
+#include "InterestSchedule.cpp" // For lazy interest accrual
 using namespace std;
 
 #ifndef ACCOUNT
@@ -19,8 +25,11 @@ public:
         return accountNumber_;
     }
 
-    double getBalance() const
+    // Settles any lazily accrued interest first
+    Money getBalance() const
     {
+        unique_lock<mutex> guard = lock();
+        settleBeforeRead();
         return balance_;
     }
 
@@ -29,65 +38,383 @@ public:
         return ownerId_;
     }
 
-    const vector<Transaction> &getTransactionHistory() const
+    // Closed set of concrete account types, for static dispatch
+    // (see AccountDispatch.cpp). GENERIC covers InvalidAccount.
+    enum class Kind : uint8_t
     {
-        return transactionHistory_;
+        GENERIC,
+        SAVINGS,
+        CHECKING
+    };
+
+    static constexpr const char *getKindName(Kind kind)
+    {
+        constexpr const char *names[] = {"Account", "Savings", "Checking"};
+        return names[static_cast<size_t>(kind)];
+    }
+
+    Kind getKind() const
+    {
+        return kind_;
     }
 
-    virtual bool deposit(double amount, const string &description)
+    // View over this account's rows in the TransactionJournal; in
+    // thread-safe mode hold lock() while using it
+    TransactionHistory getTransactionHistory() const
     {
-        if (amount <= 0)
+        settleBeforeRead();
+        return TransactionHistory(TransactionJournal::getInstance(), transactionRows_);
+    }
+
+    // --- History queries ---
+    // Each is O(log n + k) over this account's rows, oldest first. These
+    // lock the account and return their own copy of the k matching rows,
+    // valid after the lock is released; callers already holding lock() use
+    // the *Unlocked forms below, whose spans are valid while they hold it.
+
+    // Transactions with from <= timestamp < to
+    TransactionHistory getTransactionsBetween(time_t from, time_t to) const
+    {
+        unique_lock<mutex> guard = lock();
+        return getTransactionsBetweenUnlocked(from, to).copy();
+    }
+
+    // Transactions with fromId <= ID <= toId
+    TransactionHistory getTransactionsByIdRange(long fromId, long toId) const
+    {
+        unique_lock<mutex> guard = lock();
+        return getTransactionsByIdRangeUnlocked(fromId, toId).copy();
+    }
+
+    // The newest count transactions
+    TransactionHistory getLatestTransactions(size_t count) const
+    {
+        unique_lock<mutex> guard = lock();
+        return getLatestTransactionsUnlocked(count).copy();
+    }
+
+    // Up to limit transactions with ID > cursor, oldest first. Start with a
+    // cursor of 0 and pass nextCursor back to walk forward through history.
+    TransactionPage getTransactionsAfter(long cursor, size_t limit) const
+    {
+        unique_lock<mutex> guard = lock();
+        TransactionPage page = getTransactionsAfterUnlocked(cursor, limit);
+        page.transactions = page.transactions.copy();
+        return page;
+    }
+
+    // Up to limit transactions with ID < cursor, still oldest first within
+    // the page. Start with numeric_limits<long>::max() to page backwards from
+    // the newest.
+    TransactionPage getTransactionsBefore(long cursor, size_t limit) const
+    {
+        unique_lock<mutex> guard = lock();
+        TransactionPage page = getTransactionsBeforeUnlocked(cursor, limit);
+        page.transactions = page.transactions.copy();
+        return page;
+    }
+
+    // The same queries as spans into this account's rows. Like every read
+    // they settle lazily accrued interest first. Caller holds lock().
+    TransactionHistory getTransactionsBetweenUnlocked(time_t from, time_t to) const
+    {
+        settleBeforeRead();
+        const TransactionJournal &journal = TransactionJournal::getInstance();
+        const size_t *rows = transactionRows_.data();
+        size_t count = transactionRows_.size();
+        size_t first = journal.lowerBoundByTime(rows, count, from);
+        size_t last = max(first, journal.lowerBoundByTime(rows, count, to));
+        return TransactionHistory(journal, rows + first, rows + last);
+    }
+
+    TransactionHistory getTransactionsByIdRangeUnlocked(long fromId, long toId) const
+    {
+        settleBeforeRead();
+        const TransactionJournal &journal = TransactionJournal::getInstance();
+        const size_t *rows = transactionRows_.data();
+        size_t count = transactionRows_.size();
+        size_t first = journal.lowerBoundById(rows, count, fromId);
+        size_t last = (toId < fromId) ? first : journal.lowerBoundById(rows, count, toId + 1);
+        return TransactionHistory(journal, rows + first, rows + last);
+    }
+
+    TransactionHistory getLatestTransactionsUnlocked(size_t count) const
+    {
+        settleBeforeRead();
+        const size_t *end = transactionRows_.data() + transactionRows_.size();
+        return TransactionHistory(TransactionJournal::getInstance(), end - min(count, transactionRows_.size()), end);
+    }
+
+    TransactionPage getTransactionsAfterUnlocked(long cursor, size_t limit) const
+    {
+        settleBeforeRead();
+        const TransactionJournal &journal = TransactionJournal::getInstance();
+        const size_t *rows = transactionRows_.data();
+        size_t count = transactionRows_.size();
+        size_t first = journal.lowerBoundById(rows, count, cursor + 1);
+        size_t last = first + min(limit, count - first);
+        long next = (last > first) ? journal.getId(rows[last - 1]) : cursor;
+        return TransactionPage{TransactionHistory(journal, rows + first, rows + last), next, last < count};
+    }
+
+    TransactionPage getTransactionsBeforeUnlocked(long cursor, size_t limit) const
+    {
+        settleBeforeRead();
+        const TransactionJournal &journal = TransactionJournal::getInstance();
+        const size_t *rows = transactionRows_.data();
+        size_t last = journal.lowerBoundById(rows, transactionRows_.size(), cursor);
+        size_t first = last - min(limit, last);
+        long next = (last > first) ? journal.getId(rows[first]) : cursor;
+        return TransactionPage{TransactionHistory(journal, rows + first, rows + last), next, first > 0};
+    }
+
+    // --- Thread-safe mode ---
+    // When enabled, every public operation locks the account it touches.
+    // Bank::setThreadSafe is the usual way to turn this on.
+    static void setThreadSafe(bool enabled)
+    {
+        threadSafe_.store(enabled);
+    }
+
+    static bool isThreadSafe()
+    {
+        return threadSafe_.load(memory_order_relaxed);
+    }
+
+    // Returns a guard holding this account's mutex in thread-safe mode, or an
+    // empty guard otherwise
+    unique_lock<mutex> lock() const
+    {
+        unique_lock<mutex> guard(mutex_, defer_lock);
+        if (isThreadSafe())
+        {
+            guard.lock();
+        }
+        return guard;
+    }
+
+    // Locks two accounts in a fixed (address) order so that concurrent
+    // transfers A->B and B->A cannot deadlock. Either guard may be empty.
+    static void lockPair(const Account &a, const Account &b, unique_lock<mutex> &guardA, unique_lock<mutex> &guardB)
+    {
+        if (&a == &b)
+        {
+            guardA = a.lock();
+        }
+        else if (less<const Account *>()(&a, &b))
+        {
+            guardA = a.lock();
+            guardB = b.lock();
+        }
+        else
+        {
+            guardB = b.lock();
+            guardA = a.lock();
+        }
+    }
+
+    bool deposit(Money amount, const string &description)
+    {
+        Metrics::Timer timer(Metrics::Histogram::DEPOSIT_NS);
+        return postDurably(WriteAheadLog::RecordType::DEPOSIT, amount, description);
+    }
+
+    bool withdraw(Money amount, const string &description)
+    {
+        Metrics::Timer timer(Metrics::Histogram::WITHDRAWAL_NS);
+        return postDurably(WriteAheadLog::RecordType::WITHDRAWAL, amount, description);
+    }
+
+    // Committed deposits and withdrawals are appended to wal when set.
+    // Bank::enableDurability attaches its log to every account it owns.
+    void attachWriteAheadLog(WriteAheadLog *wal)
+    {
+        wal_.store(wal);
+    }
+
+    // Every later balance change is added to aggregates, under ownerTotal
+    // for the owning customer; the current balance is added now and taken
+    // out again when detached with nullptr. Bank attaches each account it
+    // registers, before the account is visible to other threads.
+    void attachAggregates(BalanceAggregates *aggregates, BalanceAggregates::CustomerTotal *ownerTotal)
+    {
+        if (aggregates_ != nullptr)
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::WARNING,
-                "Deposit failed for " + accountNumber_ + ": Invalid amount $" + to_string(amount));
+            aggregates_->removeAccount(static_cast<size_t>(kind_), journalAccountId_, *ownerTotal_, balance_);
+        }
+        aggregates_ = aggregates;
+        ownerTotal_ = ownerTotal;
+        if (aggregates_ != nullptr)
+        {
+            aggregates_->addAccount(static_cast<size_t>(kind_), journalAccountId_, *ownerTotal_, balance_);
+        }
+    }
+
+    // Lazy interest: accounts given a schedule owe interest for each period
+    // it has closed since they were last settled, and post it on their next
+    // deposit, withdrawal, balance read or statement. Bank attaches its
+    // schedule to savings accounts as it registers them, which settles
+    // them up to the periods already closed.
+    void attachInterestSchedule(const InterestSchedule *schedule)
+    {
+        interestSchedule_ = schedule;
+        settledPeriod_ = (schedule != nullptr) ? schedule->getPeriodCount() : 0;
+    }
+
+    // Posts any interest owed for closed periods. Caller holds lock().
+    void settleInterestUnlocked()
+    {
+        if (interestSchedule_ != nullptr && settledPeriod_ != interestSchedule_->getPeriodCount())
+        {
+            accrueInterestUnlocked();
+        }
+    }
+
+    // settleInterestUnlocked for read paths: the balance already owes the
+    // interest, so reading stays logically const. Caller holds lock().
+    void settleBeforeRead() const
+    {
+        const_cast<Account *>(this)->settleInterestUnlocked();
+    }
+
+    // WAL replay: the account had been settled up to period
+    void restoreSettledPeriod(uint64_t period)
+    {
+        settledPeriod_ = period;
+    }
+
+    // Caller holds lock()
+    bool depositUnlocked(Money amount, const string &description)
+    {
+        settleInterestUnlocked();
+        if (amount <= Money())
+        {
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::WARNING>(
+                DataLogEntry::EventKind::DEPOSIT_INVALID_AMOUNT, accountNumber_, amount);
             return false;
         }
-        balance_ += amount;
+        adjustBalance(amount);
         addTransaction(Transaction::Type::DEPOSIT, amount, description);
-        DataManager::getInstance().logEvent(
-            DataLogEntry::LogLevel::INFO,
-            "Deposited $" + to_string(amount) + " into " + accountNumber_ + ". New balance: $" + to_string(balance_));
+        reportDeposit(amount);
         return true;
     }
 
-    virtual bool withdraw(double amount, const string &description)
+    // Logs a deposit that has been applied. Caller holds lock().
+    void reportDeposit(Money amount) const
+    {
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::DEPOSIT, accountNumber_, amount, balance_);
+    }
+
+    // True if amount may be withdrawn under this account's rules; caller holds lock()
+    virtual bool canWithdraw(Money amount) const
+    {
+        return amount > Money() && amount <= balance_;
+    }
+
+    // Applies a validated posting whose journal row the caller has already
+    // appended, without logging. Caller holds lock().
+    void postTransaction(Transaction::Type type, Money amount, size_t journalRow)
+    {
+        adjustBalance((type == Transaction::Type::WITHDRAWAL) ? -amount : amount);
+        transactionRows_.push_back(journalRow);
+    }
+
+    // Replaces the history with count consecutive journal rows starting at
+    // firstRow (snapshot load). Caller holds lock().
+    void restoreTransactionRows(size_t firstRow, size_t count)
+    {
+        transactionRows_.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            transactionRows_[i] = firstRow + i;
+        }
+    }
+
+    // Caller holds lock()
+    Money getBalanceUnlocked() const
+    {
+        return balance_;
+    }
+
+    uint32_t getJournalAccountId() const
+    {
+        return journalAccountId_;
+    }
+
+    // Caller holds lock()
+    virtual bool withdrawUnlocked(Money amount, const string &description)
     {
-        if (amount <= 0 || amount > balance_)
+        settleInterestUnlocked();
+        if (!canWithdraw(amount))
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::WARNING,
-                "Withdrawal failed for " + accountNumber_ + ": Invalid amount $" + to_string(amount) + " or insufficient funds. Current balance: $" + to_string(balance_));
+            reportWithdrawalRejected(amount);
             return false;
         }
-        balance_ -= amount;
+        adjustBalance(-amount);
         addTransaction(Transaction::Type::WITHDRAWAL, amount, description);
-        DataManager::getInstance().logEvent(
-            DataLogEntry::LogLevel::INFO,
-            "Withdrew $" + to_string(amount) + " from " + accountNumber_ + ". New balance: $" + to_string(balance_));
+        reportWithdrawal(amount);
         return true;
     }
 
+    // The events and counters of a withdrawal canWithdraw rejected, and of
+    // one that has been applied; withdrawUnlocked uses them, as do callers
+    // that post the row themselves (Bank::transferFunds). Caller holds lock().
+    virtual void reportWithdrawalRejected(Money amount) const
+    {
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::WARNING>(
+            DataLogEntry::EventKind::WITHDRAWAL_FAILED, accountNumber_, amount, balance_);
+    }
+
+    virtual void reportWithdrawal(Money amount) const
+    {
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::WITHDRAWAL, accountNumber_, amount, balance_);
+    }
+
     virtual void performMonthlyMaintenance() {};
 
+    virtual ~Account() {}
+
+    Account(const Account &) = delete;
+    Account &operator=(const Account &) = delete;
+
     // Overload stream insertion operator for easy printing
     friend ostream &operator<<(ostream &os, const Account &account)
     {
         os << "Account Number: " << account.getAccountNumber() << "\n"
            << "  Owner ID: " << account.getOwnerId() << "\n"
-           << "  Balance: $" << fixed << setprecision(2) << account.getBalance() << "\n";
+           << "  Balance: $" << account.getBalance() << "\n";
         return os;
     }
 
-    Account(const string &ownerId, double initialBalance = 0.0)
-        : accountNumber_("ACC" + to_string(nextAccountNumber++)),
+    // Tag for constructors that rebuild an existing account (WAL replay):
+    // the account number is given rather than generated, and nothing is logged
+    struct RestoreTag
+    {
+    };
+
+    Account(RestoreTag, const string &accountNumber, const string &ownerId, Money balance)
+        : accountNumber_(accountNumber),
+          ownerId_(ownerId),
+          balance_(balance)
+    {
+        journalAccountId_ = TransactionJournal::getInstance().internAccount(accountNumber_);
+        if (accountNumber_.compare(0, 3, "ACC") == 0 && accountNumber_.size() > 3)
+        {
+            nextAccountNumber.advancePast(stoll(accountNumber_.substr(3)));
+        }
+    }
+
+    Account(const string &ownerId, Money initialBalance = Money())
+        : accountNumber_("ACC" + to_string(nextAccountNumber.next())),
           ownerId_(ownerId),
           balance_(initialBalance)
     {
+        journalAccountId_ = TransactionJournal::getInstance().internAccount(accountNumber_);
 
-        DataManager::getInstance().logEvent(
-            DataLogEntry::LogLevel::INFO,
-            "Account created: " + accountNumber_ + " for owner " + ownerId_ + " with initial balance $" + to_string(initialBalance));
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::ACCOUNT_CREATED, accountNumber_, initialBalance, Money(), ownerId_);
     }
 
     bool operator==(const Account &acct) const
@@ -98,20 +425,88 @@ public:
 
 protected:
     // Protected members
-    static int nextAccountNumber;
+    static IdSequence nextAccountNumber;
+    static atomic<bool> threadSafe_;
+    mutable mutex mutex_; // Guards balance_ and transactionRows_ in thread-safe mode
+    Kind kind_ = Kind::GENERIC; // Set by the derived constructors
     string accountNumber_;
     string ownerId_; // ID of the customer who owns this account
-    double balance_;
-    vector<Transaction> transactionHistory_;
+    Money balance_;
+    uint32_t journalAccountId_;      // accountNumber_ interned in the TransactionJournal
+    vector<size_t> transactionRows_; // This account's journal rows, oldest first
+    atomic<WriteAheadLog *> wal_{nullptr};
+    BalanceAggregates *aggregates_ = nullptr;                   // Set while registered with a Bank
+    BalanceAggregates::CustomerTotal *ownerTotal_ = nullptr;
+    const InterestSchedule *interestSchedule_ = nullptr; // Set for savings accounts registered with a Bank
+    uint64_t settledPeriod_ = 0;                         // Interest periods already posted
+
+    // Posts the interest of periods settledPeriod_.. of the schedule and
+    // advances settledPeriod_. Caller holds lock().
+    virtual void accrueInterestUnlocked()
+    {
+        settledPeriod_ = interestSchedule_->getPeriodCount();
+    }
+
+    // All balance changes after construction go through here so the
+    // attached aggregates follow them. Caller holds lock().
+    void adjustBalance(Money delta)
+    {
+        const Money before = balance_;
+        balance_ += delta;
+        if (aggregates_ != nullptr)
+        {
+            aggregates_->recordChange(static_cast<size_t>(kind_), journalAccountId_, *ownerTotal_, before, balance_);
+        }
+    }
+
+    // Runs a public deposit/withdraw under the account lock, records it in
+    // the WAL if one is attached, and waits for durability after unlocking
+    // so concurrent operations can share one sync
+    bool postDurably(WriteAheadLog::RecordType type, Money amount, const string &description)
+    {
+        WriteAheadLog *wal = wal_.load();
+        uint64_t lsn = 0;
+        {
+            unique_lock<mutex> guard = lock();
+            const bool isDeposit = (type == WriteAheadLog::RecordType::DEPOSIT);
+            bool posted = isDeposit ? depositUnlocked(amount, description) : withdrawUnlocked(amount, description);
+            if (!posted)
+            {
+                Metrics::getInstance().increment(isDeposit ? Metrics::Counter::DEPOSITS_REJECTED
+                                                           : Metrics::Counter::WITHDRAWALS_REJECTED);
+                return false;
+            }
+            Metrics::getInstance().increment(isDeposit ? Metrics::Counter::DEPOSITS : Metrics::Counter::WITHDRAWALS);
+            if (wal != nullptr)
+            {
+                lsn = logPosting(*wal, type, amount, description);
+            }
+        }
+        if (wal != nullptr)
+        {
+            wal->waitDurable(lsn);
+        }
+        return true;
+    }
+
+    // Appends a WAL record for the posting just added to this account's
+    // history. Caller holds lock().
+    uint64_t logPosting(WriteAheadLog &wal, WriteAheadLog::RecordType type, Money amount, const string &description) const
+    {
+        int64_t id = 0, timestamp = 0;
+        TransactionJournal::getInstance().getStamp(transactionRows_.back(), id, timestamp);
+        return wal.append(type, {accountNumber_, description}, {amount.getMinorUnits(), id, timestamp});
+    }
 
     // Helper to add transaction and log it
-    void addTransaction(Transaction::Type type, double amount, const string &description)
+    void addTransaction(Transaction::Type type, Money amount, const string &description)
     {
-        Transaction trans = Transaction(type, amount, accountNumber_, description);
-        transactionHistory_.push_back(trans);
+        transactionRows_.push_back(
+            TransactionJournal::getInstance().append(type, amount, journalAccountId_, description));
     }
 };
 
-int Account::nextAccountNumber = 20001;
+IdSequence Account::nextAccountNumber(20001);
+atomic<bool> Account::threadSafe_(false);
 
 #endif // ACCOUNT
\ No newline at end of file
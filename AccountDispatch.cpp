@@ -0,0 +1,82 @@
+#include <string>
+#include <utility>
+#include "Account.cpp"
+#include "SavingsAccount.cpp"
+#include "CheckingAccount.cpp"
+using namespace std;
+
+#ifndef ACCOUNTDISPATCH
+#define ACCOUNTDISPATCH
+
+// Static dispatch over the closed set of account types. visit() switches on
+// Account::getKind() and hands fn the concrete type; SavingsAccount and
+// CheckingAccount are final, so every call fn makes on it binds directly and
+// can be inlined. GENERIC accounts fall back to the virtual Account
+// interface, which stays available for existing Account& code.
+class AccountDispatch
+{
+public:
+    template <typename F>
+    static decltype(auto) visit(Account &account, F &&fn)
+    {
+        switch (account.getKind())
+        {
+        case Account::Kind::SAVINGS:
+            return forward<F>(fn)(static_cast<SavingsAccount &>(account));
+        case Account::Kind::CHECKING:
+            return forward<F>(fn)(static_cast<CheckingAccount &>(account));
+        default:
+            return forward<F>(fn)(account);
+        }
+    }
+
+    template <typename F>
+    static decltype(auto) visit(const Account &account, F &&fn)
+    {
+        switch (account.getKind())
+        {
+        case Account::Kind::SAVINGS:
+            return forward<F>(fn)(static_cast<const SavingsAccount &>(account));
+        case Account::Kind::CHECKING:
+            return forward<F>(fn)(static_cast<const CheckingAccount &>(account));
+        default:
+            return forward<F>(fn)(account);
+        }
+    }
+
+    // Caller holds account.lock()
+    static bool canWithdraw(const Account &account, Money amount)
+    {
+        return visit(account, [&](const auto &typed)
+                     { return typed.canWithdraw(amount); });
+    }
+
+    // Caller holds account.lock()
+    static bool withdrawUnlocked(Account &account, Money amount, const string &description)
+    {
+        return visit(account, [&](auto &typed)
+                     { return typed.withdrawUnlocked(amount, description); });
+    }
+
+    // The events withdrawUnlocked records, for callers that check
+    // canWithdraw and post the row themselves. Caller holds account.lock().
+    static void reportWithdrawalRejected(const Account &account, Money amount)
+    {
+        visit(account, [&](const auto &typed)
+              { typed.reportWithdrawalRejected(amount); });
+    }
+
+    static void reportWithdrawal(const Account &account, Money amount)
+    {
+        visit(account, [&](const auto &typed)
+              { typed.reportWithdrawal(amount); });
+    }
+
+    static void performMonthlyMaintenance(Account &account)
+    {
+        visit(account, [](auto &typed)
+              { typed.performMonthlyMaintenance(); });
+    }
+};
+
+#endif // ACCOUNTDISPATCH
@@ -0,0 +1,169 @@
+#include <cstddef>
+#include <cstdint>
+#include <functional> // For less<>
+#include <memory> // For unique_ptr
+#include <new>    // For placement new
+#include <utility>
+#include <vector>
+using namespace std;
+
+#ifndef ACCOUNTPOOL
+#define ACCOUNTPOOL
+
+// Owning storage for accounts of one type. Objects are constructed in place
+// inside fixed-size blocks, so they sit next to each other in memory and
+// never move: references and pointers stay valid until the object is
+// destroyed. Freed slots go on a free list and are reused by later creates.
+// A Handle names a slot plus the generation it was issued for, so a handle
+// to a closed account resolves to nullptr instead of to its replacement.
+// Not synchronized; Bank guards it with the directory lock.
+struct PoolHandle
+{
+    uint32_t slot = 0;
+    uint32_t generation = 0;
+};
+
+template <typename T>
+class AccountPool
+{
+public:
+    static const size_t BLOCK_SIZE = 4096;
+
+    using Handle = PoolHandle;
+
+    AccountPool() {}
+
+    AccountPool(const AccountPool &) = delete;
+    AccountPool &operator=(const AccountPool &) = delete;
+
+    ~AccountPool()
+    {
+        for (size_t slot = 0; slot < slotCount_; ++slot)
+        {
+            if (isLive(slot))
+            {
+                at(slot)->~T();
+            }
+        }
+    }
+
+    template <typename... Args>
+    T &create(Args &&...args)
+    {
+        size_t slot;
+        if (!freeSlots_.empty())
+        {
+            slot = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        else
+        {
+            if (slotCount_ == blocks_.size() * BLOCK_SIZE)
+            {
+                blocks_.emplace_back(new Block);
+            }
+            slot = slotCount_++;
+        }
+        T *item = new (at(slot)) T(forward<Args>(args)...);
+        block(slot).live[slot % BLOCK_SIZE] = true;
+        ++size_;
+        return *item;
+    }
+
+    // Destroys item (which must belong to this pool) and frees its slot
+    void destroy(T &item)
+    {
+        size_t slot = slotOf(&item);
+        item.~T();
+        block(slot).live[slot % BLOCK_SIZE] = false;
+        ++block(slot).generation[slot % BLOCK_SIZE];
+        freeSlots_.push_back(slot);
+        --size_;
+    }
+
+    Handle getHandle(const T &item) const
+    {
+        size_t slot = slotOf(&item);
+        return Handle{static_cast<uint32_t>(slot), block(slot).generation[slot % BLOCK_SIZE]};
+    }
+
+    // The item a handle names, or nullptr if it has been destroyed since
+    T *get(Handle handle) const
+    {
+        if (handle.slot >= slotCount_ || !isLive(handle.slot) ||
+            block(handle.slot).generation[handle.slot % BLOCK_SIZE] != handle.generation)
+        {
+            return nullptr;
+        }
+        return at(handle.slot);
+    }
+
+    // Number of live items
+    size_t size() const
+    {
+        return size_;
+    }
+
+    // Slots ever used, live or free; slot indexes run from 0 to this
+    size_t getSlotCount() const
+    {
+        return slotCount_;
+    }
+
+    bool isLive(size_t slot) const
+    {
+        return block(slot).live[slot % BLOCK_SIZE];
+    }
+
+    T *at(size_t slot) const
+    {
+        return reinterpret_cast<T *>(block(slot).storage) + slot % BLOCK_SIZE;
+    }
+
+    // Calls fn(T&) for each live item in slot order
+    template <typename F>
+    void forEach(F fn) const
+    {
+        for (size_t slot = 0; slot < slotCount_; ++slot)
+        {
+            if (isLive(slot))
+            {
+                fn(*at(slot));
+            }
+        }
+    }
+
+private:
+    struct Block
+    {
+        alignas(T) unsigned char storage[BLOCK_SIZE * sizeof(T)];
+        bool live[BLOCK_SIZE] = {};
+        uint32_t generation[BLOCK_SIZE] = {};
+    };
+
+    Block &block(size_t slot) const
+    {
+        return *blocks_[slot / BLOCK_SIZE];
+    }
+
+    // Blocks are few (one per BLOCK_SIZE slots), so a linear search is cheap
+    size_t slotOf(const T *item) const
+    {
+        for (size_t b = 0; b < blocks_.size(); ++b)
+        {
+            const T *first = reinterpret_cast<const T *>(blocks_[b]->storage);
+            if (!less<const T *>()(item, first) && less<const T *>()(item, first + BLOCK_SIZE))
+            {
+                return b * BLOCK_SIZE + static_cast<size_t>(item - first);
+            }
+        }
+        return SIZE_MAX;
+    }
+
+    vector<unique_ptr<Block>> blocks_;
+    vector<size_t> freeSlots_;
+    size_t slotCount_ = 0;
+    size_t size_ = 0;
+};
+
+#endif // ACCOUNTPOOL
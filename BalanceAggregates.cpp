@@ -0,0 +1,146 @@
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <deque> // For stable per-customer totals
+#include "Money.cpp"
+using namespace std;
+
+#ifndef BALANCEAGGREGATES
+#define BALANCEAGGREGATES
+
+// Running balance totals per account kind and per customer, updated by
+// Account on every balance change so dashboards read them in O(1) instead
+// of scanning every account. Per-kind counters are striped over cache lines
+// by account, so concurrent postings to different accounts rarely share a
+// line; reads add up the stripes.
+//
+// Totals are exact whenever no posting is in flight. While writers run, a
+// read may see one leg of a transfer but not the other; use
+// Bank::takeBalanceSnapshot for a consistent cut.
+class BalanceAggregates
+{
+public:
+    static const size_t KIND_COUNT = 3; // Indexed by Account::Kind
+
+    // One customer's net worth in cents. Lives as long as the aggregates.
+    using CustomerTotal = atomic<int64_t>;
+
+    struct Totals
+    {
+        size_t accountCount = 0;
+        Money deposits;          // Sum of positive balances
+        Money overdraftExposure; // Sum of how far negative balances are below zero
+
+        Money getNetBalance() const
+        {
+            return deposits - overdraftExposure;
+        }
+    };
+
+    // Appends the next customer's total (zero); the caller serializes
+    // additions against getCustomerTotal
+    void addCustomer()
+    {
+        customers_.emplace_back(0);
+    }
+
+    // Total of the index-th added customer
+    CustomerTotal &getCustomerTotal(size_t index)
+    {
+        return customers_[index];
+    }
+
+    const CustomerTotal &getCustomerTotal(size_t index) const
+    {
+        return customers_[index];
+    }
+
+    void addAccount(size_t kind, size_t stripe, CustomerTotal &owner, Money balance)
+    {
+        stripeFor(kind, stripe).accountCount.fetch_add(1, memory_order_relaxed);
+        recordChange(kind, stripe, owner, Money(), balance);
+    }
+
+    void removeAccount(size_t kind, size_t stripe, CustomerTotal &owner, Money balance)
+    {
+        recordChange(kind, stripe, owner, balance, Money());
+        stripeFor(kind, stripe).accountCount.fetch_sub(1, memory_order_relaxed);
+    }
+
+    // One account's balance went from before to after
+    void recordChange(size_t kind, size_t stripe, CustomerTotal &owner, Money before, Money after)
+    {
+        const int64_t from = before.getMinorUnits(), to = after.getMinorUnits();
+        if (from == to)
+        {
+            return;
+        }
+        Stripe &counters = stripeFor(kind, stripe);
+        const int64_t depositDelta = (to > 0 ? to : 0) - (from > 0 ? from : 0);
+        const int64_t exposureDelta = (to < 0 ? -to : 0) - (from < 0 ? -from : 0);
+        if (depositDelta != 0)
+        {
+            counters.deposits.fetch_add(depositDelta, memory_order_relaxed);
+        }
+        if (exposureDelta != 0)
+        {
+            counters.overdraftExposure.fetch_add(exposureDelta, memory_order_relaxed);
+        }
+        owner.fetch_add(to - from, memory_order_relaxed);
+    }
+
+    Totals getTotals(size_t kind) const
+    {
+        Totals totals;
+        int64_t deposits = 0, exposure = 0;
+        for (size_t s = 0; s < STRIPE_COUNT; ++s)
+        {
+            const Stripe &counters = stripes_[kind * STRIPE_COUNT + s];
+            totals.accountCount += static_cast<size_t>(counters.accountCount.load(memory_order_relaxed));
+            deposits += counters.deposits.load(memory_order_relaxed);
+            exposure += counters.overdraftExposure.load(memory_order_relaxed);
+        }
+        totals.deposits = Money::fromMinorUnits(deposits);
+        totals.overdraftExposure = Money::fromMinorUnits(exposure);
+        return totals;
+    }
+
+    // All kinds together
+    Totals getTotals() const
+    {
+        Totals totals;
+        for (size_t kind = 0; kind < KIND_COUNT; ++kind)
+        {
+            Totals part = getTotals(kind);
+            totals.accountCount += part.accountCount;
+            totals.deposits += part.deposits;
+            totals.overdraftExposure += part.overdraftExposure;
+        }
+        return totals;
+    }
+
+    static Money getNetWorth(const CustomerTotal &owner)
+    {
+        return Money::fromMinorUnits(owner.load(memory_order_relaxed));
+    }
+
+private:
+    static const size_t STRIPE_COUNT = 16;
+
+    struct alignas(64) Stripe
+    {
+        atomic<int64_t> accountCount{0};
+        atomic<int64_t> deposits{0};
+        atomic<int64_t> overdraftExposure{0};
+    };
+
+    Stripe stripes_[KIND_COUNT * STRIPE_COUNT];
+    deque<CustomerTotal> customers_; // deque so totals never move
+
+    Stripe &stripeFor(size_t kind, size_t stripe)
+    {
+        return stripes_[kind * STRIPE_COUNT + stripe % STRIPE_COUNT];
+    }
+};
+
+#endif // BALANCEAGGREGATES
@@ -0,0 +1,92 @@
+#include <cstddef>
+#include <ctime>     // For time_t
+#include <algorithm> // For sort, lower_bound
+#include <utility>   // For move
+#include <vector>
+#include "Account.cpp"
+#include "Money.cpp"
+using namespace std;
+
+#ifndef BALANCESNAPSHOT
+#define BALANCESNAPSHOT
+
+// Every account's balance as of one point in the TransactionJournal: the
+// balances include exactly the journal rows before getJournalPosition().
+// transferFunds and applyTransfers append both legs of a transfer in one
+// TransactionJournal::appendTransfer call, so money is never seen on both
+// sides or neither. Taken by Bank::takeBalanceSnapshot while
+// writers keep running; after that it is a plain immutable value.
+class BalanceSnapshot
+{
+public:
+    struct Entry
+    {
+        const Account *account; // Identity only; do not use once the account may have been closed
+        Account::Kind kind;
+        Money balance;
+    };
+
+    BalanceSnapshot(size_t journalPosition, time_t takenAt, vector<Entry> entries)
+        : journalPosition_(journalPosition), takenAt_(takenAt), entries_(move(entries))
+    {
+        sort(entries_.begin(), entries_.end(), [](const Entry &a, const Entry &b)
+             { return less<const Account *>()(a.account, b.account); });
+    }
+
+    // Journal rows [0, position) are reflected in the balances
+    size_t getJournalPosition() const
+    {
+        return journalPosition_;
+    }
+
+    time_t getTakenAt() const
+    {
+        return takenAt_;
+    }
+
+    // One entry per account that existed at the snapshot, ordered by address
+    const vector<Entry> &getEntries() const
+    {
+        return entries_;
+    }
+
+    size_t size() const
+    {
+        return entries_.size();
+    }
+
+    // The account's balance in the snapshot, or nullptr if it did not exist yet
+    const Money *find(const Account &account) const
+    {
+        auto it = lower_bound(entries_.begin(), entries_.end(), &account, [](const Entry &entry, const Account *wanted)
+                              { return less<const Account *>()(entry.account, wanted); });
+        return (it != entries_.end() && it->account == &account) ? &it->balance : nullptr;
+    }
+
+    Money getTotal() const
+    {
+        Money total;
+        for (const Entry &entry : entries_)
+        {
+            total += entry.balance;
+        }
+        return total;
+    }
+
+    Money getTotal(Account::Kind kind) const
+    {
+        Money total;
+        for (const Entry &entry : entries_)
+        {
+            total += (entry.kind == kind) ? entry.balance : Money();
+        }
+        return total;
+    }
+
+private:
+    size_t journalPosition_;
+    time_t takenAt_;
+    vector<Entry> entries_;
+};
+
+#endif // BALANCESNAPSHOT
@@ -2,13 +2,29 @@
 #include "SavingsAccount.cpp"  // For SavingsAccount
 #include "CheckingAccount.cpp" // For CheckingAccount
 #include "Customer.cpp"        // For Customer class
+#include "CustomerNameIndex.cpp" // For name search
 #include "Account.cpp"         // For Account class
+#include "BankSnapshot.cpp"    // For the snapshot file format
+#include "AccountPool.cpp"     // For account storage
+#include "AccountDispatch.cpp" // For static dispatch on account type
+#include "BalanceSnapshot.cpp" // For point-in-time balance reads
+#include "BalanceAggregates.cpp" // For running totals
+#include "InterestSchedule.cpp" // For lazy interest accrual
 
 #include <iostream>
 #include <string>
 #include <vector>
+#include <deque>         // For stable customer storage
+#include <unordered_map> // For account/customer lookup indexes
+#include <mutex>
+#include <shared_mutex>  // For the directory lock in thread-safe mode
 #include <algorithm> // For find_if
 #include <numeric>   // For accumulate
+#include <thread>    // For batch transfer workers
+#include <atomic>
+#include <cstdint>
+#include <memory> // For the owned WriteAheadLog
+#include <chrono>
 using namespace std;
 
 #ifndef BANK
@@ -29,173 +45,1604 @@ public:
         return name_;
     }
 
-    // --- Customer Management ---
-    Customer createCustomer(const string &name, const string &address, const string &phone)
+    // Thread-safe mode: accounts are locked individually for each operation
+    // (transfers take both locks in a fixed order) and the customer/account
+    // directory is guarded by a reader-writer lock. Off by default.
+    void setThreadSafe(bool enabled)
+    {
+        Account::setThreadSafe(enabled);
+    }
+
+    // --- Durability ---
+    // Starts recording every committed change (customers, accounts,
+    // deposits, withdrawals, transfers, interest) in a write-ahead log at
+    // path. In WAIT_FOR_COMMIT mode each operation returns only once its
+    // record is synced; concurrent operations share syncs (group commit).
+    void enableDurability(const string &path,
+                          WriteAheadLog::SyncMode mode = WriteAheadLog::SyncMode::WAIT_FOR_COMMIT,
+                          chrono::microseconds commitInterval = chrono::microseconds(1000))
+    {
+        unique_lock<shared_mutex> directoryGuard = lockDirectory();
+        detachWriteAheadLog();
+        wal_.reset(new WriteAheadLog(path, mode, commitInterval));
+        for (auto &entry : accountIndex_)
+        {
+            entry.second->attachWriteAheadLog(wal_.get());
+        }
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Durability enabled: write-ahead log " + path + ".");
+    }
+
+    // Syncs and closes the write-ahead log; call when no operations are running
+    void disableDurability()
+    {
+        unique_lock<shared_mutex> directoryGuard = lockDirectory();
+        detachWriteAheadLog();
+    }
+
+    WriteAheadLog *getWriteAheadLog() const
+    {
+        return wal_.get();
+    }
+
+    // Rebuilds state from the write-ahead log at path by re-applying every
+    // record with LSN > afterLsn, without re-logging or re-validating them.
+    // Meant for a freshly constructed Bank before durability is enabled;
+    // postings a loaded snapshot already has are skipped.
+    // Returns the number of records applied.
+    size_t replayWriteAheadLog(const string &path, uint64_t afterLsn = 0)
+    {
+        if (wal_)
+        {
+            throw logic_error("Cannot replay a WAL while durability is enabled");
+        }
+        unique_lock<shared_mutex> directoryGuard = lockDirectory();
+        TransactionJournal &journal = TransactionJournal::getInstance();
+        auto find = [&](const string &accountNumber) -> Account &
+        {
+            auto it = accountIndex_.find(accountNumber);
+            if (it == accountIndex_.end())
+            {
+                throw runtime_error("WAL refers to unknown account " + accountNumber);
+            }
+            return *it->second;
+        };
+        // Re-posts one logged transaction with its original ID and timestamp,
+        // unless the loaded snapshot already has it
+        auto restorePosting = [&](Account &account, Transaction::Type type, const string &description,
+                                  const int64_t *amountIdTimestamp)
+        {
+            if (amountIdTimestamp[1] < firstUnsavedTransactionId_)
+            {
+                return;
+            }
+            uint8_t typeCode = static_cast<uint8_t>(type);
+            uint32_t descriptionId = journal.internDescription(description);
+            size_t row = journal.appendRestored(account.getJournalAccountId(), 1, &amountIdTimestamp[1], &amountIdTimestamp[2],
+                                                &typeCode, &amountIdTimestamp[0], &descriptionId);
+            account.postTransaction(type, Money::fromMinorUnits(amountIdTimestamp[0]), row);
+        };
+        string fromDescription, toDescription;
+        size_t applied = WriteAheadLog::replay(path, [&](const WalRecord &record)
+                                               {
+            const vector<string> &texts = record.texts;
+            const vector<int64_t> &values = record.values;
+            // Field counts are checked before any field is read
+            auto expect = [&](bool wellFormed)
+            {
+                if (!wellFormed)
+                {
+                    throw runtime_error("Malformed WAL record at LSN " + to_string(record.lsn) + ": type " +
+                                        to_string(record.type) + " with " + to_string(texts.size()) + " texts and " +
+                                        to_string(values.size()) + " values");
+                }
+            };
+            auto hasFields = [&](size_t textCount, size_t valueCount)
+            {
+                return texts.size() == textCount && values.size() == valueCount;
+            };
+            switch (static_cast<WriteAheadLog::RecordType>(record.type))
+            {
+            case WriteAheadLog::RecordType::CUSTOMER_CREATED:
+                expect(hasFields(4, 0));
+                registerCustomer(Customer::restore(texts[0], texts[1], texts[2], texts[3]));
+                break;
+            case WriteAheadLog::RecordType::SAVINGS_ACCOUNT_CREATED:
+            {
+                expect(hasFields(2, 2));
+                SavingsAccount &account = savingsPool_.create(Account::RestoreTag(), texts[0], texts[1],
+                                                              Money::fromMinorUnits(values[0]),
+                                                              InterestRate::fromPartsPerMillion(values[1]));
+                registerAccount(&account, customerIndex_.at(texts[1]), true);
+                break;
+            }
+            case WriteAheadLog::RecordType::CHECKING_ACCOUNT_CREATED:
+            {
+                expect(hasFields(2, 2));
+                CheckingAccount &account = checkingPool_.create(Account::RestoreTag(), texts[0], texts[1],
+                                                                Money::fromMinorUnits(values[0]),
+                                                                Money::fromMinorUnits(values[1]));
+                registerAccount(&account, customerIndex_.at(texts[1]), true);
+                break;
+            }
+            case WriteAheadLog::RecordType::ACCOUNT_CLOSED:
+                expect(hasFields(1, 0));
+                unregisterAccount(find(texts[0]));
+                break;
+            case WriteAheadLog::RecordType::DEPOSIT:
+            case WriteAheadLog::RecordType::WITHDRAWAL:
+            {
+                expect(hasFields(2, 3));
+                Transaction::Type type = (static_cast<WriteAheadLog::RecordType>(record.type) == WriteAheadLog::RecordType::DEPOSIT)
+                                             ? Transaction::Type::DEPOSIT
+                                             : Transaction::Type::WITHDRAWAL;
+                restorePosting(find(texts[0]), type, texts[1], &values[0]);
+                break;
+            }
+            case WriteAheadLog::RecordType::TRANSFER:
+            {
+                expect(hasFields(3, 5));
+                buildTransferDescriptions(texts[0], texts[1], texts[2], fromDescription, toDescription);
+                const int64_t fromLeg[3] = {values[0], values[1], values[2]};
+                const int64_t toLeg[3] = {values[0], values[3], values[4]};
+                restorePosting(find(texts[0]), Transaction::Type::WITHDRAWAL, fromDescription, fromLeg);
+                restorePosting(find(texts[1]), Transaction::Type::DEPOSIT, toDescription, toLeg);
+                break;
+            }
+            case WriteAheadLog::RecordType::INTEREST_CREDITS:
+            {
+                expect(values.size() == 3 * texts.size());
+                for (size_t i = 0; i < texts.size(); ++i)
+                {
+                    restorePosting(find(texts[i]), Transaction::Type::DEPOSIT, "Monthly Interest", &values[3 * i]);
+                }
+                break;
+            }
+            case WriteAheadLog::RecordType::INTEREST_PERIOD_CLOSED:
+                expect(hasFields(0, 1));
+                interestSchedule_.closePeriod(static_cast<time_t>(values[0]));
+                break;
+            case WriteAheadLog::RecordType::INTEREST_SETTLED:
+            {
+                expect(texts.size() == 1 && !values.empty() && (values.size() - 1) % 3 == 0);
+                Account &account = find(texts[0]);
+                for (size_t i = 1; i < values.size(); i += 3)
+                {
+                    restorePosting(account, Transaction::Type::DEPOSIT, "Monthly Interest", &values[i]);
+                }
+                account.restoreSettledPeriod(static_cast<uint64_t>(values[0]));
+                break;
+            }
+            default:
+                throw runtime_error("Unknown WAL record type " + to_string(record.type));
+            } },
+                                               afterLsn);
+        settledThrough_.store(0, memory_order_release); // Replayed accounts may owe interest again
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Replayed " + to_string(applied) + " records from write-ahead log " + path + ".");
+        return applied;
+    }
+
+    // --- Snapshots ---
+    // Writes customers, accounts and their histories to a versioned binary
+    // snapshot at path (see BankSnapshot.cpp), without stopping writers.
+    // Like takeBalanceSnapshot it cuts the journal at one position and
+    // locks each account only while copying its rows before the cut.
+    // Accounts cannot be opened or closed meanwhile. Returns the WAL
+    // position to replay from (0 without durability); records after it
+    // whose transactions are already in the snapshot are skipped on replay.
+    uint64_t saveSnapshot(const string &path) const
+    {
+        BankSnapshot::Writer writer;
+        BankSnapshot::Header header = {};
+        {
+            shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+            settleAllInterestShared();
+            // Postings reach the journal before the WAL, so every record up
+            // to here has its rows before the cut taken next
+            header.walLsn = wal_ ? wal_->getLastLsn() : 0;
+            TransactionJournal &journal = TransactionJournal::getInstance();
+            long firstUnsavedId = 0;
+            const size_t position = journal.getPosition(firstUnsavedId);
+            header.firstUnsavedTransactionId = firstUnsavedId;
+            header.interestPeriodCount = interestSchedule_.getPeriodCount();
+            header.savingsCount = savingsPool_.size();
+            header.checkingCount = checkingPool_.size();
+
+            // Savings first, then checking, each in pool order
+            vector<const Account *> accounts;
+            vector<int64_t> parameters; // Interest rate or overdraft limit, per account
+            accounts.reserve(savingsPool_.size() + checkingPool_.size());
+            parameters.reserve(savingsPool_.size() + checkingPool_.size());
+            savingsPool_.forEach([&](const SavingsAccount &account)
+                                 {
+                accounts.push_back(&account);
+                parameters.push_back(account.getInterestRate().getPartsPerMillion()); });
+            checkingPool_.forEach([&](const CheckingAccount &account)
+                                  {
+                accounts.push_back(&account);
+                parameters.push_back(account.getOverdraftLimit().getMinorUnits()); });
+
+            unordered_map<const Account *, uint32_t> accountPositions;
+            for (size_t i = 0; i < accounts.size(); ++i)
+            {
+                accountPositions.emplace(accounts[i], static_cast<uint32_t>(i));
+            }
+            unordered_map<string, uint32_t> customerIds; // Customer ID -> string index, reused as account owner
+            for (const Customer &customer : customers_)
+            {
+                BankSnapshot::CustomerRecord record = {};
+                record.id = writer.addString(customer.getCustomerId());
+                record.name = writer.addString(customer.getName());
+                record.address = writer.addString(customer.getAddress());
+                record.phone = writer.addString(customer.getPhone());
+                record.firstAccount = static_cast<uint32_t>(header.customerAccountCount);
+                for (Account *account : customer.getAccounts())
+                {
+                    writer.add(BankSnapshot::CUSTOMER_ACCOUNTS, accountPositions.at(account));
+                    ++record.accountCount;
+                }
+                header.customerAccountCount += record.accountCount;
+                customerIds.emplace(customer.getCustomerId(), record.id);
+                writer.add(BankSnapshot::CUSTOMERS, record);
+            }
+            header.customerCount = customers_.size();
+
+            vector<int64_t> ids, timestamps, amounts;
+            vector<uint8_t> types;
+            vector<uint32_t> descriptions;
+            unordered_map<uint32_t, uint32_t> descriptionStrings; // Journal description ID -> string index
+            for (size_t i = 0; i < accounts.size(); ++i)
+            {
+                const Account &account = *accounts[i];
+                const size_t first = ids.size();
+                size_t saved = 0;
+                Money balance;
+                {
+                    unique_lock<mutex> guard = account.lock();
+                    const TransactionHistory rows = account.getTransactionHistory();
+                    ids.resize(first + rows.size());
+                    timestamps.resize(first + rows.size());
+                    amounts.resize(first + rows.size());
+                    types.resize(first + rows.size());
+                    descriptions.resize(first + rows.size());
+                    journal.readRows(rows.getRows(), rows.size(), &ids[first], &timestamps[first], &types[first], &amounts[first], &descriptions[first]);
+                    saved = static_cast<size_t>(lower_bound(rows.getRows(), rows.getRows() + rows.size(), position) - rows.getRows());
+                    balance = account.getBalanceUnlocked();
+                }
+                // Take rows posted after the cut back out of the balance
+                for (size_t k = first + saved; k < ids.size(); ++k)
+                {
+                    const Money amount = Money::fromMinorUnits(amounts[k]);
+                    balance -= (static_cast<Transaction::Type>(types[k]) == Transaction::Type::WITHDRAWAL) ? -amount : amount;
+                }
+                ids.resize(first + saved);
+                timestamps.resize(first + saved);
+                amounts.resize(first + saved);
+                types.resize(first + saved);
+                descriptions.resize(first + saved);
+                for (size_t k = first; k < descriptions.size(); ++k)
+                {
+                    auto it = descriptionStrings.find(descriptions[k]);
+                    if (it == descriptionStrings.end())
+                    {
+                        it = descriptionStrings.emplace(descriptions[k], writer.addString(journal.getDescription(descriptions[k]))).first;
+                    }
+                    descriptions[k] = it->second;
+                }
+
+                BankSnapshot::AccountRecord record = {};
+                record.number = writer.addString(account.getAccountNumber());
+                record.owner = customerIds.at(account.getOwnerId());
+                record.balance = balance.getMinorUnits();
+                record.parameter = parameters[i];
+                record.firstTransaction = first;
+                record.transactionCount = saved;
+                writer.add(BankSnapshot::ACCOUNTS, record);
+            }
+            header.transactionCount = ids.size();
+            writer.addAll(BankSnapshot::TRANSACTION_IDS, ids);
+            writer.addAll(BankSnapshot::TIMESTAMPS, timestamps);
+            writer.addAll(BankSnapshot::AMOUNTS, amounts);
+            writer.addAll(BankSnapshot::DESCRIPTIONS, descriptions);
+            writer.addAll(BankSnapshot::TYPES, types);
+        }
+        writer.write(path, header);
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Snapshot written to " + path + ": " + to_string(header.customerCount) + " customers, " +
+                to_string(header.savingsCount + header.checkingCount) + " accounts, " +
+                to_string(header.transactionCount) + " transactions.");
+        return header.walLsn;
+    }
+
+    // Loads a snapshot into this (empty) Bank by mapping the file and
+    // copying each account's transaction slice into the journal. Returns
+    // the WAL position to pass to replayWriteAheadLog to apply the tail
+    // written after the snapshot.
+    uint64_t loadSnapshot(const string &path)
     {
-        const Customer newCustomer = Customer(name, address, phone);
-        customers_.push_back(newCustomer);
+        if (wal_)
+        {
+            throw logic_error("Cannot load a snapshot while durability is enabled");
+        }
+        unique_lock<shared_mutex> directoryGuard = lockDirectory();
+        if (!customers_.empty())
+        {
+            throw logic_error("Snapshots can only be loaded into an empty Bank");
+        }
+        BankSnapshot::View view(path);
+        const BankSnapshot::Header &header = view.header();
+        auto text = [&](uint32_t index)
+        {
+            if (index >= header.stringCount)
+            {
+                throw runtime_error("Snapshot " + path + " refers to a missing string");
+            }
+            return string(view.getString(index));
+        };
+
+        interestSchedule_.restore(header.interestPeriodCount);
+        firstUnsavedTransactionId_ = header.firstUnsavedTransactionId;
+        const BankSnapshot::CustomerRecord *customerRecords = view.section<BankSnapshot::CustomerRecord>(BankSnapshot::CUSTOMERS);
+        customerIndex_.reserve(header.customerCount);
+        for (uint64_t c = 0; c < header.customerCount; ++c)
+        {
+            const BankSnapshot::CustomerRecord &record = customerRecords[c];
+            registerCustomer(Customer::restore(text(record.id), text(record.name), text(record.address), text(record.phone)));
+        }
+
+        TransactionJournal &journal = TransactionJournal::getInstance();
+        const BankSnapshot::AccountRecord *accountRecords = view.section<BankSnapshot::AccountRecord>(BankSnapshot::ACCOUNTS);
+        const int64_t *ids = view.section<int64_t>(BankSnapshot::TRANSACTION_IDS);
+        const int64_t *timestamps = view.section<int64_t>(BankSnapshot::TIMESTAMPS);
+        const int64_t *amounts = view.section<int64_t>(BankSnapshot::AMOUNTS);
+        const uint32_t *descriptions = view.section<uint32_t>(BankSnapshot::DESCRIPTIONS);
+        const uint8_t *types = view.section<uint8_t>(BankSnapshot::TYPES);
+        const uint64_t accountCount = header.savingsCount + header.checkingCount;
+        vector<Account *> accounts(accountCount);
+        vector<uint32_t> descriptionIds(header.stringCount, UINT32_MAX); // String index -> journal ID, interned on first use
+        vector<uint32_t> remapped;
+        for (uint64_t i = 0; i < accountCount; ++i)
+        {
+            const BankSnapshot::AccountRecord &record = accountRecords[i];
+            if (record.firstTransaction > header.transactionCount ||
+                record.transactionCount > header.transactionCount - record.firstTransaction)
+            {
+                throw runtime_error("Snapshot " + path + " has a corrupt account record");
+            }
+            string owner = text(record.owner);
+            auto ownerPosition = customerIndex_.find(owner);
+            if (ownerPosition == customerIndex_.end())
+            {
+                throw runtime_error("Snapshot " + path + " refers to unknown customer " + owner);
+            }
+            Money balance = Money::fromMinorUnits(record.balance);
+            if (i < header.savingsCount)
+            {
+                accounts[i] = &savingsPool_.create(Account::RestoreTag(), text(record.number), owner, balance,
+                                                   InterestRate::fromPartsPerMillion(record.parameter));
+                accounts[i]->attachInterestSchedule(&interestSchedule_);
+            }
+            else
+            {
+                accounts[i] = &checkingPool_.create(Account::RestoreTag(), text(record.number), owner, balance,
+                                                    Money::fromMinorUnits(record.parameter));
+            }
+            accountIndex_.emplace(accounts[i]->getAccountNumber(), accounts[i]);
+            accounts[i]->attachAggregates(&aggregates_, &aggregates_.getCustomerTotal(ownerPosition->second));
+
+            const size_t first = record.firstTransaction, count = record.transactionCount;
+            remapped.resize(count);
+            for (size_t k = 0; k < count; ++k)
+            {
+                uint32_t index = descriptions[first + k];
+                if (index >= header.stringCount)
+                {
+                    throw runtime_error("Snapshot " + path + " refers to a missing string");
+                }
+                if (descriptionIds[index] == UINT32_MAX)
+                {
+                    descriptionIds[index] = journal.internDescription(text(index));
+                }
+                remapped[k] = descriptionIds[index];
+            }
+            size_t row = journal.appendRestored(accounts[i]->getJournalAccountId(), count, ids + first, timestamps + first,
+                                                types + first, amounts + first, remapped.data());
+            accounts[i]->restoreTransactionRows(row, count);
+        }
+
+        // Link accounts to customers in each customer's original order
+        const uint32_t *customerAccounts = view.section<uint32_t>(BankSnapshot::CUSTOMER_ACCOUNTS);
+        for (uint64_t c = 0; c < header.customerCount; ++c)
+        {
+            const BankSnapshot::CustomerRecord &record = customerRecords[c];
+            if (record.firstAccount > header.customerAccountCount ||
+                record.accountCount > header.customerAccountCount - record.firstAccount)
+            {
+                throw runtime_error("Snapshot " + path + " has a corrupt customer record");
+            }
+            for (uint32_t k = record.firstAccount; k < record.firstAccount + record.accountCount; ++k)
+            {
+                if (customerAccounts[k] >= accountCount)
+                {
+                    throw runtime_error("Snapshot " + path + " has a corrupt customer record");
+                }
+                customers_[c].addRestoredAccount(accounts[customerAccounts[k]]);
+            }
+        }
         DataManager::getInstance().logEvent(
             DataLogEntry::LogLevel::INFO,
-            "New customer registered: " + newCustomer.getCustomerId() + " (" + newCustomer.getName() + ")");
-        return newCustomer;
+            "Snapshot loaded from " + path + ": " + to_string(header.customerCount) + " customers, " +
+                to_string(accountCount) + " accounts, " + to_string(header.transactionCount) + " transactions.");
+        return header.walLsn;
+    }
+
+    // --- Point-in-time reads ---
+    // Balances of all accounts as of one position in the TransactionJournal,
+    // without stopping writers: each account is locked only long enough to
+    // read its balance and any rows posted after the position, which are
+    // then taken back out. Accounts cannot be opened or closed meanwhile.
+    BalanceSnapshot takeBalanceSnapshot() const
+    {
+        const TransactionJournal &journal = TransactionJournal::getInstance();
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        settleAllInterestShared();
+        // Every row before the position belongs to an operation that holds
+        // its account locks until the row is posted, and operations that
+        // post to several accounts append all their rows in one call
+        const size_t position = journal.size();
+        const time_t takenAt = time(nullptr);
+
+        vector<BalanceSnapshot::Entry> entries;
+        vector<size_t> laterRows;     // Rows at or after position, in entry order
+        vector<uint32_t> laterOwners; // Entry index of each later row
+        entries.reserve(savingsPool_.size() + checkingPool_.size());
+        auto capture = [&](const Account &account)
+        {
+            unique_lock<mutex> guard = account.lock();
+            const TransactionHistory history = account.getTransactionHistory();
+            const size_t *rowsEnd = history.getRows() + history.size();
+            for (const size_t *row = lower_bound(history.getRows(), rowsEnd, position); row != rowsEnd; ++row)
+            {
+                laterRows.push_back(*row);
+                laterOwners.push_back(static_cast<uint32_t>(entries.size()));
+            }
+            entries.push_back({&account, account.getKind(), account.getBalanceUnlocked()});
+        };
+        savingsPool_.forEach(capture);
+        checkingPool_.forEach(capture);
+        if (directoryGuard.owns_lock())
+        {
+            directoryGuard.unlock();
+        }
+
+        if (!laterRows.empty())
+        {
+            const size_t count = laterRows.size();
+            vector<int64_t> ids(count), timestamps(count), amounts(count);
+            vector<uint8_t> types(count);
+            vector<uint32_t> descriptionIds(count);
+            journal.readRows(laterRows.data(), count, ids.data(), timestamps.data(), types.data(),
+                             amounts.data(), descriptionIds.data());
+            for (size_t i = 0; i < count; ++i)
+            {
+                const Money amount = Money::fromMinorUnits(amounts[i]);
+                Money &balance = entries[laterOwners[i]].balance;
+                balance -= (static_cast<Transaction::Type>(types[i]) == Transaction::Type::WITHDRAWAL) ? -amount : amount;
+            }
+        }
+        return BalanceSnapshot(position, takenAt, move(entries));
     }
 
-    Customer getCustomer(const string &customerId) const
+    // --- Running totals ---
+    // Kept up to date by every deposit, withdrawal, transfer and interest
+    // credit, so these are O(1) (see BalanceAggregates.cpp). Exact once
+    // writers are idle; use takeBalanceSnapshot for a cut taken mid-traffic.
+    // In lazy interest mode the first read after a month-end settles every
+    // savings account, so the totals include the interest they owe.
+    BalanceAggregates::Totals getBalanceTotals(Account::Kind kind) const
     {
-        for (Customer cust : customers_)
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        settleAllInterestShared();
+        return aggregates_.getTotals(static_cast<size_t>(kind));
+    }
+
+    // All account kinds together
+    BalanceAggregates::Totals getBalanceTotals() const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        settleAllInterestShared();
+        return aggregates_.getTotals();
+    }
+
+    // Sum of the customer's account balances; zero for an unknown customer
+    Money getCustomerNetWorth(const string &customerId) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        settleAllInterestShared();
+        auto it = customerIndex_.find(customerId);
+        if (it == customerIndex_.end())
+        {
+            return Money();
+        }
+        return BalanceAggregates::getNetWorth(aggregates_.getCustomerTotal(it->second));
+    }
+
+    // Debug check: recomputes every running total from the accounts, with
+    // all of them locked, and logs an error for each one that disagrees.
+    // O(accounts); returns true if all match.
+    bool verifyBalanceTotals() const
+    {
+        unique_lock<shared_mutex> directoryGuard = lockDirectory();
+        vector<Account *> ordered;
+        ordered.reserve(savingsPool_.size() + checkingPool_.size());
+        savingsPool_.forEach([&](Account &account)
+                             { ordered.push_back(&account); });
+        checkingPool_.forEach([&](Account &account)
+                              { ordered.push_back(&account); });
+        sort(ordered.begin(), ordered.end(), less<Account *>());
+        vector<unique_lock<mutex>> guards;
+        guards.reserve(ordered.size());
+        for (Account *account : ordered)
+        {
+            guards.push_back(account->lock());
+            account->settleInterestUnlocked(); // The totals follow the postings it makes
+        }
+
+        BalanceAggregates::Totals expected[BalanceAggregates::KIND_COUNT];
+        for (Account *account : ordered)
+        {
+            BalanceAggregates::Totals &totals = expected[static_cast<size_t>(account->getKind())];
+            const Money balance = account->getBalanceUnlocked();
+            ++totals.accountCount;
+            totals.deposits += (balance > Money()) ? balance : Money();
+            totals.overdraftExposure += (balance < Money()) ? -balance : Money();
+        }
+        bool consistent = true;
+        auto mismatch = [&](const string &what, const string &kept, const string &actual)
         {
-            if (cust.getCustomerId() == customerId)
+            consistent = false;
+            DataManager::getInstance().logEvent(
+                DataLogEntry::LogLevel::ERROR,
+                "Running total " + what + " is " + kept + " but the accounts give " + actual + ".");
+        };
+        for (size_t kind = 0; kind < BalanceAggregates::KIND_COUNT; ++kind)
+        {
+            const BalanceAggregates::Totals kept = aggregates_.getTotals(kind);
+            const string name = Account::getKindName(static_cast<Account::Kind>(kind));
+            if (kept.accountCount != expected[kind].accountCount)
+            {
+                mismatch(name + " account count", to_string(kept.accountCount), to_string(expected[kind].accountCount));
+            }
+            if (kept.deposits != expected[kind].deposits)
+            {
+                mismatch(name + " deposits", kept.deposits.toString(), expected[kind].deposits.toString());
+            }
+            if (kept.overdraftExposure != expected[kind].overdraftExposure)
             {
-                return cust;
+                mismatch(name + " overdraft exposure", kept.overdraftExposure.toString(),
+                         expected[kind].overdraftExposure.toString());
             }
         }
-        return Customer::getInvalidCustomer();
+        for (size_t c = 0; c < customers_.size(); ++c)
+        {
+            Money netWorth;
+            for (const Account *account : customers_[c].getAccounts())
+            {
+                netWorth += account->getBalanceUnlocked();
+            }
+            const Money kept = BalanceAggregates::getNetWorth(aggregates_.getCustomerTotal(c));
+            if (kept != netWorth)
+            {
+                mismatch("net worth of " + customers_[c].getCustomerId(), kept.toString(), netWorth.toString());
+            }
+        }
+        return consistent;
     }
 
-    Customer getCustomerByName(const string &name) const
+    // --- Customer Management ---
+    // Customers are never removed and never move, so the references these
+    // return stay valid for the Bank's lifetime. Lookups that fail return
+    // Customer::getInvalidCustomer().
+    const Customer &createCustomer(const string &name, const string &address, const string &phone)
     {
-        for (Customer cust : customers_)
+        Customer created(name, address, phone);
+        const Customer *newCustomer;
+        uint64_t lsn = 0;
         {
-            if (cust.getName().compare(name) == 0)
+            unique_lock<shared_mutex> directoryGuard = lockDirectory();
+            newCustomer = &registerCustomer(move(created));
+            if (wal_)
             {
-                return cust;
+                lsn = wal_->append(WriteAheadLog::RecordType::CUSTOMER_CREATED,
+                                   {newCustomer->getCustomerId(), newCustomer->getName(), newCustomer->getAddress(),
+                                    newCustomer->getPhone()},
+                                   {});
             }
         }
-        return Customer::getInvalidCustomer();
+        waitDurable(lsn);
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "New customer registered: " + newCustomer->getCustomerId() + " (" + newCustomer->getName() + ")");
+        return *newCustomer;
+    }
+
+    const Customer &getCustomer(const string &customerId) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        auto it = customerIndex_.find(customerId);
+        if (it == customerIndex_.end())
+        {
+            return Customer::getInvalidCustomer();
+        }
+        return customers_[it->second];
+    }
+
+    // First registered customer with exactly this name
+    const Customer &getCustomerByName(const string &name) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        const Customer *customer = nameIndex_.findFirst(name);
+        return customer != nullptr ? *customer : Customer::getInvalidCustomer();
+    }
+
+    // --- Name search ---
+    // Served by an ordered index of case-folded names kept up to date as
+    // customers are registered: O(log n + k) for k results.
+
+    // Every customer with this name, in registration order
+    vector<const Customer *> findCustomersByName(const string &name,
+                                                 CustomerNameIndex::CaseMode mode = CustomerNameIndex::CaseMode::SENSITIVE) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        return nameIndex_.findByName(name, mode);
     }
 
-    vector<Customer> getAllCustomers() const
+    // Type-ahead: up to limit customers whose name starts with prefix, in
+    // case-insensitive name order
+    vector<const Customer *> findCustomersByNamePrefix(const string &prefix, size_t limit,
+                                                       CustomerNameIndex::CaseMode mode = CustomerNameIndex::CaseMode::INSENSITIVE) const
     {
-        return customers_;
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        return nameIndex_.findByPrefix(prefix, mode, limit);
+    }
+
+    // View over every customer, without copying; see CustomerRange for when
+    // to use withCustomers instead
+    CustomerRange getAllCustomers() const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        return CustomerRange(customers_);
     }
 
     // --- Account Management ---
-    Account &createSavingsAccount(const string &customerId, double initialBalance, double interestRate)
+    Account &createSavingsAccount(const string &customerId, Money initialBalance, InterestRate interestRate)
     {
-        Customer customer = getCustomer(customerId);
-        if (customer == Customer::getInvalidCustomer())
+        unique_lock<shared_mutex> directoryGuard = lockDirectory();
+        auto it = customerIndex_.find(customerId);
+        if (it == customerIndex_.end())
         {
             DataManager::getInstance().logEvent(
                 DataLogEntry::LogLevel::ERROR,
                 "Failed to create SavingsAccount: Customer " + customerId + " not found.");
             throw runtime_error("Customer not found");
         }
-        Account *newAccount = new SavingsAccount(customerId, initialBalance, interestRate);
-        customer.addAccount(newAccount);
+        SavingsAccount *newAccount = &savingsPool_.create(customerId, initialBalance, interestRate);
+        registerAccount(newAccount, it->second);
+        if (wal_)
+        {
+            uint64_t lsn = wal_->append(WriteAheadLog::RecordType::SAVINGS_ACCOUNT_CREATED,
+                                        {newAccount->getAccountNumber(), customerId},
+                                        {initialBalance.getMinorUnits(), interestRate.getPartsPerMillion()});
+            if (directoryGuard.owns_lock())
+            {
+                directoryGuard.unlock();
+            }
+            waitDurable(lsn);
+        }
         return *newAccount;
     }
 
-    Account &createCheckingAccount(const string &customerId, double initialBalance, double overdraftLimit)
+    Account &createCheckingAccount(const string &customerId, Money initialBalance, Money overdraftLimit)
     {
-        Customer customer = getCustomer(customerId);
-        if (customer == Customer::getInvalidCustomer())
+        unique_lock<shared_mutex> directoryGuard = lockDirectory();
+        auto it = customerIndex_.find(customerId);
+        if (it == customerIndex_.end())
         {
             DataManager::getInstance().logEvent(
                 DataLogEntry::LogLevel::ERROR,
                 "Failed to create CheckingAccount: Customer " + customerId + " not found.");
             throw runtime_error("Customer not found");
         }
-        Account* newAccount = new CheckingAccount(customerId, initialBalance, overdraftLimit);
-        customer.addAccount(newAccount);
+        CheckingAccount *newAccount = &checkingPool_.create(customerId, initialBalance, overdraftLimit);
+        registerAccount(newAccount, it->second);
+        if (wal_)
+        {
+            uint64_t lsn = wal_->append(WriteAheadLog::RecordType::CHECKING_ACCOUNT_CREATED,
+                                        {newAccount->getAccountNumber(), customerId},
+                                        {initialBalance.getMinorUnits(), overdraftLimit.getMinorUnits()});
+            if (directoryGuard.owns_lock())
+            {
+                directoryGuard.unlock();
+            }
+            waitDurable(lsn);
+        }
         return *newAccount;
     }
 
     Account *getAccount(const string &accountNumber) const
     {
-        for (Customer cust : customers_)
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        return findAccountUnlocked(accountNumber);
+    }
+
+    // Names an account across calls without a string lookup or a pointer
+    // that closing the account would leave dangling: it resolves to the
+    // InvalidAccount sentinel once the account is closed, even after a new
+    // account reuses its pool slot
+    struct AccountHandle
+    {
+        Account::Kind kind = Account::Kind::GENERIC; // GENERIC: no such account
+        PoolHandle slot;
+    };
+
+    AccountHandle getAccountHandle(const string &accountNumber) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        AccountHandle handle;
+        Account *account = findAccountUnlocked(accountNumber);
+        handle.kind = account->getKind();
+        if (handle.kind == Account::Kind::SAVINGS)
         {
-            Account *acct = cust.getAccount(accountNumber);
-            if (acct != nullptr)
-            {
-                if (acct->getAccountNumber() == accountNumber)
-                {
-                    return acct;
-                }
-            }
+            handle.slot = savingsPool_.getHandle(static_cast<SavingsAccount &>(*account));
+        }
+        else if (handle.kind == Account::Kind::CHECKING)
+        {
+            handle.slot = checkingPool_.getHandle(static_cast<CheckingAccount &>(*account));
+        }
+        return handle;
+    }
+
+    // The account a handle names, or the InvalidAccount sentinel if it has
+    // been closed. Same lifetime rules as the pointer getAccount returns.
+    Account *getAccount(AccountHandle handle) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        Account *account = nullptr;
+        if (handle.kind == Account::Kind::SAVINGS)
+        {
+            account = savingsPool_.get(handle.slot);
+        }
+        else if (handle.kind == Account::Kind::CHECKING)
+        {
+            account = checkingPool_.get(handle.slot);
         }
-        return nullptr;
+        return account != nullptr ? account : InvalidAccount::getInstance();
     }
 
+    // Savings accounts, then checking accounts, each in pool order
     vector<Account *> getAllAccounts() const
     {
         vector<Account *> allAccounts;
-        for (Customer cust : customers_)
+        allAccounts.reserve(savingsPool_.size() + checkingPool_.size());
+        forEachAccount([&](Account &account)
+                       { allAccounts.push_back(&account); });
+        return allAccounts;
+    }
+
+    // Calls fn with every account as its concrete type, one pool at a time,
+    // so a generic lambda gets a loop per type with direct (inlinable)
+    // calls. Holds the directory lock shared; fn must not create or close
+    // accounts.
+    template <typename F>
+    void forEachAccount(F fn) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        savingsPool_.forEach(fn);
+        checkingPool_.forEach(fn);
+    }
+
+    // Calls fn(CustomerRange) with the directory lock held shared, so the
+    // customers and their account lists cannot change while fn runs (bulk
+    // readers split the range between threads). Same restrictions on fn as
+    // forEachAccount.
+    template <typename F>
+    void withCustomers(F fn) const
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        fn(CustomerRange(customers_));
+    }
+
+    // Closes an account with a zero balance: it is removed from its customer
+    // and the directory and its pool slot is freed for reuse. Returns false
+    // if the account does not exist or still holds money. References to the
+    // account must not be used once it is closed.
+    bool closeAccount(const string &accountNumber)
+    {
+        uint64_t lsn = 0;
         {
-            for (Account *acct : cust.getAccounts())
+            unique_lock<shared_mutex> directoryGuard = lockDirectory();
+            auto it = accountIndex_.find(accountNumber);
+            if (it == accountIndex_.end())
+            {
+                DataManager::getInstance().logEvent(
+                    DataLogEntry::LogLevel::ERROR,
+                    "Failed to close account " + accountNumber + ": account not found.");
+                return false;
+            }
+            Account &account = *it->second;
+            {
+                // Waits for any operation still running on the account
+                unique_lock<mutex> accountGuard = account.lock();
+                if (account.getBalanceUnlocked() != Money())
+                {
+                    DataManager::getInstance().logEvent(
+                        DataLogEntry::LogLevel::WARNING,
+                        "Cannot close account " + accountNumber + ": balance is $" +
+                            account.getBalanceUnlocked().toString() + ".");
+                    return false;
+                }
+            }
+            if (wal_)
             {
-                allAccounts.push_back(acct);
+                lsn = wal_->append(WriteAheadLog::RecordType::ACCOUNT_CLOSED, {accountNumber}, {});
             }
+            unregisterAccount(account);
         }
-        return allAccounts;
+        waitDurable(lsn);
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Account " + accountNumber + " closed.");
+        return true;
     }
 
     // --- Transaction Processing ---
-    bool transferFunds(const string &fromAccountNum, const string &toAccountNum, double amount, const string &description)
+    bool transferFunds(const string &fromAccountNum, const string &toAccountNum, Money amount, const string &description)
     {
-        if (amount <= 0)
+        Metrics::Timer timer(Metrics::Histogram::TRANSFER_NS);
+        if (amount <= Money())
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::WARNING,
-                "Transfer failed: Invalid amount $" + to_string(amount));
+            Metrics::getInstance().increment(Metrics::Counter::TRANSFERS_INVALID_AMOUNT);
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::WARNING>(
+                DataLogEntry::EventKind::TRANSFER_INVALID_AMOUNT, string(), amount);
             return false;
         }
 
-        Account *fromAccount = getAccount(fromAccountNum);
-        Account *toAccount = getAccount(toAccountNum);
+        // Held until both legs are posted, so neither account can be closed
+        // (and its slot reused) between the lookup and the transfer
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        Account *fromAccount = findAccountUnlocked(fromAccountNum);
+        Account *toAccount = findAccountUnlocked(toAccountNum);
 
         if (*fromAccount == *(InvalidAccount::getInstance()))
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::ERROR,
-                "Transfer failed: Source account " + fromAccountNum + " not found.");
+            Metrics::getInstance().increment(Metrics::Counter::TRANSFERS_SOURCE_NOT_FOUND);
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::ERROR>(
+                DataLogEntry::EventKind::TRANSFER_SOURCE_NOT_FOUND, fromAccountNum);
             return false;
         }
         if (*toAccount == *(InvalidAccount::getInstance()))
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::ERROR,
-                "Transfer failed: Destination account " + toAccountNum + " not found.");
+            Metrics::getInstance().increment(Metrics::Counter::TRANSFERS_DESTINATION_NOT_FOUND);
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::ERROR>(
+                DataLogEntry::EventKind::TRANSFER_DESTINATION_NOT_FOUND, toAccountNum);
             return false;
         }
 
-        if (fromAccount->withdraw(amount, "Transfer to " + toAccountNum + (description.empty() ? "" : ": " + description)))
+        string fromDescription, toDescription;
+        buildTransferDescriptions(fromAccountNum, toAccountNum, description, fromDescription, toDescription);
+        uint64_t lsn = 0;
         {
-            toAccount->deposit(amount, "Transfer from " + fromAccountNum + (description.empty() ? "" : ": " + description));
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::INFO,
-                "Successfully transferred $" + to_string(amount) + " from " + fromAccountNum + " to " + toAccountNum + (description.empty() ? "" : " (" + description + ")"));
-            return true;
+            // Both accounts stay locked for the whole transfer, so other threads
+            // never see the money missing from both or present in both
+            unique_lock<mutex> fromGuard, toGuard;
+            Account::lockPair(*fromAccount, *toAccount, fromGuard, toGuard);
+            fromAccount->settleInterestUnlocked();
+            toAccount->settleInterestUnlocked();
+            if (!AccountDispatch::canWithdraw(*fromAccount, amount))
+            {
+                AccountDispatch::reportWithdrawalRejected(*fromAccount, amount);
+                Metrics::getInstance().increment(Metrics::Counter::TRANSFERS_INSUFFICIENT_FUNDS);
+                DataManager::getInstance().logEvent<DataLogEntry::LogLevel::WARNING>(
+                    DataLogEntry::EventKind::TRANSFER_WITHDRAWAL_FAILED, fromAccountNum, amount, Money(), toAccountNum);
+                return false;
+            }
+            // The legs are adjacent journal rows appended under one journal
+            // lock, so a balance snapshot never picks its position between them
+            size_t row = TransactionJournal::getInstance().appendTransfer(
+                fromAccount->getJournalAccountId(), toAccount->getJournalAccountId(), amount, fromDescription, toDescription);
+            fromAccount->postTransaction(Transaction::Type::WITHDRAWAL, amount, row);
+            toAccount->postTransaction(Transaction::Type::DEPOSIT, amount, row + 1);
+            AccountDispatch::reportWithdrawal(*fromAccount, amount);
+            toAccount->reportDeposit(amount);
+            if (wal_)
+            {
+                lsn = logTransfer(fromAccountNum, toAccountNum, description, amount, row, row + 1);
+            }
         }
-        else
+        if (directoryGuard.owns_lock())
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::WARNING,
-                "Transfer failed between " + fromAccountNum + " and " + toAccountNum + " due to withdrawal issue.");
-            return false;
+            directoryGuard.unlock();
+        }
+        waitDurable(lsn);
+        Metrics::getInstance().increment(Metrics::Counter::TRANSFERS);
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::TRANSFER_COMPLETED, fromAccountNum, amount, Money(), toAccountNum, description);
+        return true;
+    }
+
+    // --- Batch Transfers ---
+    struct TransferRequest
+    {
+        string fromAccount;
+        string toAccount;
+        Money amount;
+        string description;
+    };
+
+    enum class TransferStatus : uint8_t
+    {
+        OK,
+        INVALID_AMOUNT,
+        SOURCE_NOT_FOUND,
+        DESTINATION_NOT_FOUND,
+        INSUFFICIENT_FUNDS
+    };
+
+    // Applies a batch with the same per-item outcome as calling transferFunds
+    // on each request in order. Accounts are resolved once up front, then the
+    // batch is split into groups that share no account; groups run in
+    // parallel on up to workerCount threads (0 = hardware concurrency) while
+    // the items inside a group keep their batch order. Returns one status per
+    // request and logs a single summary instead of per-transfer events.
+    vector<TransferStatus> applyTransfers(const vector<TransferRequest> &batch, unsigned workerCount = 0)
+    {
+        const size_t count = batch.size();
+        const uint32_t NONE = UINT32_MAX;
+        vector<TransferStatus> status(count, TransferStatus::OK);
+        vector<Account *> from(count, nullptr), to(count, nullptr);
+        // Held until every worker is done, so no resolved account can be
+        // closed while the batch runs
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (batch[i].amount <= Money())
+            {
+                status[i] = TransferStatus::INVALID_AMOUNT;
+                continue;
+            }
+            auto fromIt = accountIndex_.find(batch[i].fromAccount);
+            if (fromIt == accountIndex_.end())
+            {
+                status[i] = TransferStatus::SOURCE_NOT_FOUND;
+                continue;
+            }
+            auto toIt = accountIndex_.find(batch[i].toAccount);
+            if (toIt == accountIndex_.end())
+            {
+                status[i] = TransferStatus::DESTINATION_NOT_FOUND;
+                continue;
+            }
+            from[i] = fromIt->second;
+            to[i] = toIt->second;
+        }
+
+        // Union-find over the accounts the batch touches: two items end up in
+        // the same group exactly when they are linked by shared accounts
+        unordered_map<Account *, uint32_t> slotOf;
+        vector<uint32_t> parent;
+        auto slot = [&](Account *account)
+        {
+            auto inserted = slotOf.emplace(account, static_cast<uint32_t>(parent.size()));
+            if (inserted.second)
+            {
+                parent.push_back(inserted.first->second);
+            }
+            return inserted.first->second;
+        };
+        auto root = [&](uint32_t x)
+        {
+            while (parent[x] != x)
+            {
+                parent[x] = parent[parent[x]];
+                x = parent[x];
+            }
+            return x;
+        };
+        vector<uint32_t> itemSlot(count, NONE);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (from[i] == nullptr)
+            {
+                continue;
+            }
+            uint32_t a = slot(from[i]);
+            uint32_t b = root(slot(to[i]));
+            uint32_t ra = root(a);
+            if (ra != b)
+            {
+                parent[ra] = b;
+            }
+            itemSlot[i] = a;
+        }
+
+        // Counting sort of items into groups, batch order preserved in each
+        vector<uint32_t> groupOf(parent.size(), NONE);
+        vector<size_t> groupStart;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (itemSlot[i] == NONE)
+            {
+                continue;
+            }
+            uint32_t r = root(itemSlot[i]);
+            if (groupOf[r] == NONE)
+            {
+                groupOf[r] = static_cast<uint32_t>(groupStart.size());
+                groupStart.push_back(0);
+            }
+            itemSlot[i] = groupOf[r];
+            ++groupStart[itemSlot[i]];
+        }
+        const size_t groupCount = groupStart.size();
+        vector<size_t> groupSize(groupStart);
+        size_t offset = 0;
+        for (size_t g = 0; g < groupCount; ++g)
+        {
+            size_t size = groupStart[g];
+            groupStart[g] = offset;
+            offset += size;
+        }
+        vector<size_t> items(offset);
+        {
+            vector<size_t> fill(groupStart);
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (itemSlot[i] != NONE)
+                {
+                    items[fill[itemSlot[i]]++] = i;
+                }
+            }
+        }
+
+        // Largest groups first so a long chain does not start last
+        vector<uint32_t> order(groupCount);
+        iota(order.begin(), order.end(), 0);
+        sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b)
+             { return groupSize[a] > groupSize[b]; });
+
+        atomic<size_t> nextGroup(0);
+        auto worker = [&]()
+        {
+            string fromDescription, toDescription; // Reused per item
+            for (size_t g = nextGroup.fetch_add(1); g < groupCount; g = nextGroup.fetch_add(1))
+            {
+                uint32_t group = order[g];
+                for (size_t k = groupStart[group]; k < groupStart[group] + groupSize[group]; ++k)
+                {
+                    size_t i = items[k];
+                    status[i] = applyResolvedTransfer(*from[i], *to[i], batch[i], fromDescription, toDescription);
+                }
+            }
+        };
+
+        if (workerCount == 0)
+        {
+            workerCount = max(1u, thread::hardware_concurrency());
         }
+        size_t threadCount = min<size_t>(workerCount, groupCount);
+        vector<thread> workers;
+        for (size_t t = 1; t < threadCount; ++t)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (thread &t : workers)
+        {
+            t.join();
+        }
+        if (directoryGuard.owns_lock())
+        {
+            directoryGuard.unlock();
+        }
+        if (wal_)
+        {
+            waitDurable(wal_->getLastLsn()); // One wait for the whole batch
+        }
+
+        size_t succeeded = static_cast<size_t>(count_if(status.begin(), status.end(), [](TransferStatus s)
+                                                         { return s == TransferStatus::OK; }));
+        countTransferOutcomes(status);
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Applied batch of " + to_string(count) + " transfers: " + to_string(succeeded) + " succeeded, " +
+                to_string(count - succeeded) + " failed.");
+        return status;
     }
 
     // --- System Operations ---
-    void runMonthlyMaintenance()
+    // How runMonthlyMaintenance pays savings interest. EAGER credits every
+    // savings account at once. LAZY only closes the month: each account
+    // posts the interest it owes for closed months the next time it is
+    // used (balance read, deposit, withdrawal, transfer, statement, export
+    // or snapshot), with the same amounts, descriptions and timestamps as
+    // EAGER. Only their transaction IDs, assigned when posted, differ.
+    enum class InterestMode
     {
+        EAGER,
+        LAZY
+    };
+
+    // Not to be called while maintenance runs. Switching to EAGER settles
+    // every account first.
+    void setInterestMode(InterestMode mode)
+    {
+        if (mode == InterestMode::EAGER)
+        {
+            settleAllInterest();
+        }
+        interestMode_ = mode;
+    }
+
+    InterestMode getInterestMode() const
+    {
+        return interestMode_;
+    }
+
+    // Posts the lazily accrued interest of one account now (e.g. before a
+    // month-end report on it). Returns false if the account does not exist.
+    bool settleInterest(const string &accountNumber)
+    {
+        Account *account = getAccount(accountNumber);
+        if (*account == *(InvalidAccount::getInstance()))
+        {
+            return false;
+        }
+        unique_lock<mutex> guard = account->lock();
+        account->settleInterestUnlocked();
+        return true;
+    }
+
+    // Posts the lazily accrued interest of every account
+    void settleAllInterest()
+    {
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        settleAllInterestShared();
+    }
+
+    // Runs maintenance per account type instead of one virtual call per
+    // account. Savings interest is computed in chunks with
+    // Ledger::computeInterest over contiguous balance/rate arrays, spread over
+    // up to workerCount threads (0 = hardware concurrency), and each account
+    // still gets its own "Monthly Interest" transaction. Logs one summary per
+    // account type rather than one line per account. In LAZY interest mode
+    // it only closes the month, in O(1).
+    void runMonthlyMaintenance(unsigned workerCount = 0)
+    {
+        Metrics::Timer timer(Metrics::Histogram::MAINTENANCE_NS);
+        Metrics::getInstance().increment(Metrics::Counter::MAINTENANCE_RUNS);
         DataManager::getInstance().logEvent(
             DataLogEntry::LogLevel::INFO,
             "Starting monthly maintenance for all accounts...");
-        for (Customer cust : customers_)
+        if (interestMode_ == InterestMode::LAZY)
+        {
+            closeInterestPeriod();
+            return;
+        }
+
+        // Held throughout so the pools cannot change under the workers
+        shared_lock<shared_mutex> directoryGuard = lockDirectoryShared();
+        const size_t savingsCount = savingsPool_.size();
+        const size_t checkingCount = checkingPool_.size();
+        const size_t slotCount = savingsPool_.getSlotCount();
+
+        const size_t chunkCount = (slotCount + MAINTENANCE_CHUNK - 1) / MAINTENANCE_CHUNK;
+        if (workerCount == 0)
+        {
+            workerCount = max(1u, thread::hardware_concurrency());
+        }
+        atomic<size_t> nextChunk(0);
+        atomic<size_t> credited(0);
+        atomic<int64_t> totalInterest(0);
+        auto worker = [&]()
         {
-            for (Account *acct : cust.getAccounts())
+            size_t workerCredited = 0;
+            int64_t workerInterest = 0;
+            vector<SavingsAccount *> chunk;
+            chunk.reserve(MAINTENANCE_CHUNK);
+            for (size_t c = nextChunk.fetch_add(1); c < chunkCount; c = nextChunk.fetch_add(1))
             {
-                acct->performMonthlyMaintenance();
+                // Live accounts in this range of pool slots
+                chunk.clear();
+                size_t end = min((c + 1) * MAINTENANCE_CHUNK, slotCount);
+                for (size_t slot = c * MAINTENANCE_CHUNK; slot < end; ++slot)
+                {
+                    if (savingsPool_.isLive(slot))
+                    {
+                        chunk.push_back(savingsPool_.at(slot));
+                    }
+                }
+                applyInterestChunk(chunk.data(), chunk.size(), wal_.get(), workerCredited, workerInterest);
             }
+            credited += workerCredited;
+            totalInterest += workerInterest;
+        };
+        size_t threadCount = min<size_t>(workerCount, chunkCount);
+        vector<thread> workers;
+        for (size_t t = 1; t < threadCount; ++t)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+        for (thread &t : workers)
+        {
+            t.join();
+        }
+        if (wal_)
+        {
+            waitDurable(wal_->getLastLsn());
         }
+
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Monthly interest of $" + Money::fromMinorUnits(totalInterest).toString() + " applied to " +
+                to_string(credited.load()) + " of " + to_string(savingsCount) + " SavingsAccounts.");
+        if (credited < savingsCount)
+        {
+            DataManager::getInstance().logEvent(
+                DataLogEntry::LogLevel::ERROR,
+                "Failed to apply interest to " + to_string(savingsCount - credited) + " SavingsAccounts (interest not positive).");
+        }
+        // CheckingAccount has no monthly maintenance beyond the record of it
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Performed monthly maintenance for " + to_string(checkingCount) + " CheckingAccounts.");
         DataManager::getInstance().logEvent(
             DataLogEntry::LogLevel::INFO,
             "Monthly maintenance completed.");
     }
 
 private:
+    static const size_t MAINTENANCE_CHUNK = 4096;
+
+    // LAZY month-end: records the period's close time. Taken with the
+    // directory lock exclusive so no balance snapshot or account
+    // registration sees the period count change part way through.
+    void closeInterestPeriod()
+    {
+        uint64_t lsn = 0;
+        size_t savingsCount = 0, checkingCount = 0;
+        uint64_t period = 0;
+        {
+            unique_lock<shared_mutex> directoryGuard = lockDirectory();
+            const time_t end = TransactionJournal::getInstance().now();
+            if (wal_)
+            {
+                lsn = wal_->append(WriteAheadLog::RecordType::INTEREST_PERIOD_CLOSED, {}, {static_cast<int64_t>(end)});
+            }
+            interestSchedule_.closePeriod(end);
+            period = interestSchedule_.getPeriodCount();
+            savingsCount = savingsPool_.size();
+            checkingCount = checkingPool_.size();
+        }
+        waitDurable(lsn);
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Interest period " + to_string(period) + " closed; " + to_string(savingsCount) +
+                " SavingsAccounts will be credited when next used.");
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Performed monthly maintenance for " + to_string(checkingCount) + " CheckingAccounts.");
+        DataManager::getInstance().logEvent(
+            DataLogEntry::LogLevel::INFO,
+            "Monthly maintenance completed.");
+    }
+
+    // Settles every savings account, one lock at a time, unless that has
+    // been done since the last close. Caller holds the directory lock
+    // (shared is enough: periods close only under exclusive).
+    void settleAllInterestShared() const
+    {
+        const uint64_t periods = interestSchedule_.getPeriodCount();
+        if (periods == settledThrough_.load(memory_order_acquire) || periods == interestSchedule_.getFirstKnownPeriod())
+        {
+            return; // No period closed since every account was last settled, registered or loaded
+        }
+        savingsPool_.forEach([](SavingsAccount &account)
+                             {
+            unique_lock<mutex> guard = account.lock();
+            account.settleInterestUnlocked(); });
+        settledThrough_.store(periods, memory_order_release);
+    }
+
+    // Applies monthly interest to count savings accounts: lock them all in
+    // address order (the same order lockPair uses, so this cannot deadlock
+    // with transfers), gather balances and rates, run the interest kernel,
+    // then post every credit with one journal append and, if wal is set, one
+    // INTEREST_CREDITS record.
+    static void applyInterestChunk(SavingsAccount *const *accounts, size_t count, WriteAheadLog *wal,
+                                   size_t &credited, int64_t &totalInterest)
+    {
+        vector<SavingsAccount *> ordered(accounts, accounts + count);
+        sort(ordered.begin(), ordered.end(), less<Account *>());
+        vector<unique_lock<mutex>> guards;
+        guards.reserve(count);
+        for (SavingsAccount *account : ordered)
+        {
+            guards.push_back(account->lock());
+        }
+
+        // Gather in registry order so journal rows (and transaction IDs) follow it
+        vector<int64_t> balances(count), rates(count), interest(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            balances[i] = accounts[i]->getBalanceUnlocked().getMinorUnits();
+            rates[i] = accounts[i]->getInterestRate().getPartsPerMillion();
+        }
+        Ledger::computeInterest(balances.data(), rates.data(), interest.data(), count);
+
+        // Keep only positive credits, as SavingsAccount::applyInterest does
+        vector<uint32_t> creditIds;
+        vector<int64_t> creditAmounts;
+        vector<SavingsAccount *> creditAccounts;
+        creditIds.reserve(count);
+        creditAmounts.reserve(count);
+        creditAccounts.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (interest[i] > 0)
+            {
+                creditIds.push_back(accounts[i]->getJournalAccountId());
+                creditAmounts.push_back(interest[i]);
+                creditAccounts.push_back(accounts[i]);
+                totalInterest += interest[i];
+            }
+        }
+        if (creditAccounts.empty())
+        {
+            return;
+        }
+        size_t row = TransactionJournal::getInstance().appendBatch(
+            Transaction::Type::DEPOSIT, creditIds.data(), creditAmounts.data(), creditIds.size(), "Monthly Interest");
+        for (size_t i = 0; i < creditAccounts.size(); ++i)
+        {
+            creditAccounts[i]->postTransaction(Transaction::Type::DEPOSIT, Money::fromMinorUnits(creditAmounts[i]), row + i);
+        }
+        if (wal != nullptr)
+        {
+            TransactionJournal &journal = TransactionJournal::getInstance();
+            vector<string> numbers;
+            vector<string_view> texts;
+            vector<int64_t> values(3 * creditAccounts.size());
+            numbers.reserve(creditAccounts.size());
+            texts.reserve(creditAccounts.size());
+            for (size_t i = 0; i < creditAccounts.size(); ++i)
+            {
+                numbers.push_back(creditAccounts[i]->getAccountNumber());
+                texts.push_back(numbers.back());
+                values[3 * i] = creditAmounts[i];
+                journal.getStamp(row + i, values[3 * i + 1], values[3 * i + 2]);
+            }
+            wal->append(WriteAheadLog::RecordType::INTEREST_CREDITS, texts, values);
+        }
+        credited += creditAccounts.size();
+    }
+
+    // One batch item with both accounts already resolved. The description
+    // buffers are reused across items to avoid a string build per transfer.
+    // Counts the same overdraft metrics as transferFunds (through
+    // CheckingAccount's report calls) but logs no per-item events; the
+    // TRANSFERS_* counters are added per batch by countTransferOutcomes.
+    TransferStatus applyResolvedTransfer(Account &fromAccount, Account &toAccount, const TransferRequest &request,
+                                         string &fromDescription, string &toDescription)
+    {
+        buildTransferDescriptions(request.fromAccount, request.toAccount, request.description, fromDescription, toDescription);
+
+        unique_lock<mutex> fromGuard, toGuard;
+        Account::lockPair(fromAccount, toAccount, fromGuard, toGuard);
+        fromAccount.settleInterestUnlocked();
+        toAccount.settleInterestUnlocked();
+        const bool checking = fromAccount.getKind() == Account::Kind::CHECKING;
+        if (!AccountDispatch::canWithdraw(fromAccount, request.amount))
+        {
+            if (checking)
+            {
+                Metrics::getInstance().increment(Metrics::Counter::OVERDRAFT_LIMIT_EXCEEDED);
+            }
+            return TransferStatus::INSUFFICIENT_FUNDS;
+        }
+        size_t row = TransactionJournal::getInstance().appendTransfer(
+            fromAccount.getJournalAccountId(), toAccount.getJournalAccountId(), request.amount,
+            fromDescription, toDescription);
+        fromAccount.postTransaction(Transaction::Type::WITHDRAWAL, request.amount, row);
+        toAccount.postTransaction(Transaction::Type::DEPOSIT, request.amount, row + 1);
+        if (checking && fromAccount.getBalanceUnlocked() < Money())
+        {
+            Metrics::getInstance().increment(Metrics::Counter::OVERDRAFTS_INCURRED);
+        }
+        if (wal_)
+        {
+            logTransfer(request.fromAccount, request.toAccount, request.description, request.amount, row, row + 1);
+        }
+        return TransferStatus::OK;
+    }
+
+    // Adds a batch's per-status totals to the transfer counters, once per
+    // batch rather than once per item
+    static void countTransferOutcomes(const vector<TransferStatus> &status)
+    {
+        Metrics &metrics = Metrics::getInstance();
+        if (!metrics.isEnabled())
+        {
+            return;
+        }
+        uint64_t totals[5] = {};
+        for (TransferStatus s : status)
+        {
+            ++totals[static_cast<size_t>(s)];
+        }
+        metrics.increment(Metrics::Counter::TRANSFERS, totals[static_cast<size_t>(TransferStatus::OK)]);
+        metrics.increment(Metrics::Counter::TRANSFERS_INVALID_AMOUNT, totals[static_cast<size_t>(TransferStatus::INVALID_AMOUNT)]);
+        metrics.increment(Metrics::Counter::TRANSFERS_SOURCE_NOT_FOUND, totals[static_cast<size_t>(TransferStatus::SOURCE_NOT_FOUND)]);
+        metrics.increment(Metrics::Counter::TRANSFERS_DESTINATION_NOT_FOUND,
+                          totals[static_cast<size_t>(TransferStatus::DESTINATION_NOT_FOUND)]);
+        metrics.increment(Metrics::Counter::TRANSFERS_INSUFFICIENT_FUNDS,
+                          totals[static_cast<size_t>(TransferStatus::INSUFFICIENT_FUNDS)]);
+    }
+
+    // Appends a TRANSFER record for legs already posted at the given journal
+    // rows. Caller holds both account locks.
+    uint64_t logTransfer(const string &fromAccountNum, const string &toAccountNum, const string &description,
+                         Money amount, size_t fromRow, size_t toRow)
+    {
+        int64_t fromId = 0, fromTimestamp = 0, toId = 0, toTimestamp = 0;
+        TransactionJournal::getInstance().getStamp(fromRow, fromId, fromTimestamp);
+        TransactionJournal::getInstance().getStamp(toRow, toId, toTimestamp);
+        return wal_->append(WriteAheadLog::RecordType::TRANSFER, {fromAccountNum, toAccountNum, description},
+                            {amount.getMinorUnits(), fromId, fromTimestamp, toId, toTimestamp});
+    }
+
+    // Journal descriptions of the two legs of a transfer
+    static void buildTransferDescriptions(const string &fromAccountNum, const string &toAccountNum, const string &description,
+                                          string &fromDescription, string &toDescription)
+    {
+        fromDescription.assign("Transfer to ").append(toAccountNum);
+        toDescription.assign("Transfer from ").append(fromAccountNum);
+        if (!description.empty())
+        {
+            fromDescription.append(": ").append(description);
+            toDescription.append(": ").append(description);
+        }
+    }
+
+    // Moves customer into storage and returns the stored one. Caller holds
+    // the directory lock exclusively.
+    Customer &registerCustomer(Customer &&customer)
+    {
+        customerIndex_.emplace(customer.getCustomerId(), customers_.size());
+        customers_.push_back(move(customer));
+        aggregates_.addCustomer();
+        nameIndex_.add(customers_.back());
+        return customers_.back();
+    }
+
+    // Caller holds the directory lock exclusively
+    void registerAccount(Account *account, size_t customerPosition, bool restoring = false)
+    {
+        if (restoring)
+        {
+            customers_[customerPosition].addRestoredAccount(account);
+        }
+        else
+        {
+            customers_[customerPosition].addAccount(account);
+        }
+        accountIndex_.emplace(account->getAccountNumber(), account);
+        account->attachWriteAheadLog(wal_.get());
+        account->attachAggregates(&aggregates_, &aggregates_.getCustomerTotal(customerPosition));
+        if (account->getKind() == Account::Kind::SAVINGS)
+        {
+            account->attachInterestSchedule(&interestSchedule_);
+        }
+    }
+
+    // Removes account from its customer, the directory and its pool, which
+    // destroys it. Caller holds the directory lock exclusively.
+    void unregisterAccount(Account &account)
+    {
+        auto owner = customerIndex_.find(account.getOwnerId());
+        if (owner != customerIndex_.end())
+        {
+            customers_[owner->second].removeAccount(&account);
+        }
+        account.attachAggregates(nullptr, nullptr);
+        accountIndex_.erase(account.getAccountNumber());
+        if (account.getKind() == Account::Kind::SAVINGS)
+        {
+            savingsPool_.destroy(static_cast<SavingsAccount &>(account));
+        }
+        else
+        {
+            checkingPool_.destroy(static_cast<CheckingAccount &>(account));
+        }
+    }
+
+    // Caller holds the directory lock exclusively
+    void detachWriteAheadLog()
+    {
+        if (!wal_)
+        {
+            return;
+        }
+        for (auto &entry : accountIndex_)
+        {
+            entry.second->attachWriteAheadLog(nullptr);
+        }
+        // Detached before the final commit, which throws if the log failed
+        unique_ptr<WriteAheadLog> wal = move(wal_);
+        wal->commit();
+    }
+
+    void waitDurable(uint64_t lsn)
+    {
+        if (wal_ && lsn != 0)
+        {
+            wal_->waitDurable(lsn);
+        }
+    }
+
+    // Directory guards; both are empty unless thread-safe mode is on
+    unique_lock<shared_mutex> lockDirectory() const
+    {
+        unique_lock<shared_mutex> guard(directoryMutex_, defer_lock);
+        if (Account::isThreadSafe())
+        {
+            guard.lock();
+        }
+        return guard;
+    }
+
+    // The account with this number, or the InvalidAccount sentinel; the
+    // caller holds the directory lock
+    Account *findAccountUnlocked(const string &accountNumber) const
+    {
+        auto it = accountIndex_.find(accountNumber);
+        if (it == accountIndex_.end())
+        {
+            return InvalidAccount::getInstance();
+        }
+        return it->second;
+    }
+
+    shared_lock<shared_mutex> lockDirectoryShared() const
+    {
+        shared_lock<shared_mutex> guard(directoryMutex_, defer_lock);
+        if (Account::isThreadSafe())
+        {
+            guard.lock();
+        }
+        return guard;
+    }
+
     string name_;
-    vector<Customer> customers_; // Bank owns its customers
+    mutable shared_mutex directoryMutex_;
+    deque<Customer> customers_; // Bank owns its customers; deque so they never move
+    // Lookup indexes kept in step with customers_ by the create* methods
+    unordered_map<string, size_t> customerIndex_;     // customer ID -> position in customers_
+    CustomerNameIndex nameIndex_;                     // folded name -> customers
+    unordered_map<string, Account *> accountIndex_;   // account number -> account
+    // Accounts partitioned by type for maintenance
+    AccountPool<SavingsAccount> savingsPool_;
+    AccountPool<CheckingAccount> checkingPool_;
+    unique_ptr<WriteAheadLog> wal_; // Set while durability is enabled
+    InterestSchedule interestSchedule_; // Month-ends closed in lazy interest mode
+    mutable atomic<uint64_t> settledThrough_{0}; // Period count when settleAllInterestShared last finished
+    long firstUnsavedTransactionId_ = 0; // From the loaded snapshot; WAL replay skips earlier postings
+    InterestMode interestMode_ = InterestMode::EAGER;
+    BalanceAggregates aggregates_;  // Running totals; one customer total per customers_ entry
 };
 
 #endif // BANK
\ No newline at end of file
@@ -0,0 +1,329 @@
+#include <cstdint>
+#include <cstring> // For memcmp, memcpy
+#include <cstdio>  // For FILE
+#include <string>
+#include <string_view>
+#include <vector>
+#include <stdexcept> // For runtime_error
+#ifdef _WIN32
+#include <fstream> // Whole-file read stands in for mmap
+#include <io.h>    // For _commit
+#else
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close, fsync
+#endif
+using namespace std;
+
+#ifndef BANKSNAPSHOT
+#define BANKSNAPSHOT
+
+// Versioned binary snapshot of a Bank, laid out so the file can be mapped
+// and read in place. Every section is a packed array of fixed-size records
+// (or a plain column) starting on an 8-byte boundary; strings live in one
+// table and are referenced by index. Each account's transactions are a
+// contiguous slice of the transaction columns (so the slice needs no
+// account column), and loading them is a bulk copy plus remapping string
+// indexes to journal IDs.
+//
+// File layout: Header, then the sections at the offsets it records.
+// Integers are stored in host byte order.
+class BankSnapshot
+{
+public:
+    static constexpr char MAGIC[8] = {'B', 'A', 'N', 'K', 'S', 'N', 'P', '1'};
+    static const uint32_t VERSION = 3; // 2: interestPeriodCount, 3: firstUnsavedTransactionId
+
+    enum Section
+    {
+        CUSTOMERS,         // CustomerRecord[customerCount]
+        CUSTOMER_ACCOUNTS, // uint32_t account index per customer account, grouped by customer
+        ACCOUNTS,          // AccountRecord[savingsCount + checkingCount], savings first
+        TRANSACTION_IDS,   // int64_t[transactionCount]
+        TIMESTAMPS,        // int64_t[transactionCount]
+        AMOUNTS,           // int64_t[transactionCount], minor units
+        DESCRIPTIONS,      // uint32_t[transactionCount], string index
+        TYPES,             // uint8_t[transactionCount]
+        STRING_OFFSETS,    // uint64_t[stringCount + 1] into STRING_DATA
+        STRING_DATA,       // char[]
+        SECTION_COUNT
+    };
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint64_t fileSize;
+        uint64_t walLsn; // WAL records up to here are reflected; later ones may be in part
+        uint64_t customerCount;
+        uint64_t customerAccountCount;
+        uint64_t savingsCount;
+        uint64_t checkingCount;
+        uint64_t transactionCount;
+        uint64_t stringCount;
+        uint64_t interestPeriodCount; // Lazy interest periods closed; every account is settled up to it
+        int64_t firstUnsavedTransactionId; // Transactions with this ID or later are not in the snapshot
+        uint64_t sectionOffsets[SECTION_COUNT];
+    };
+
+    struct CustomerRecord
+    {
+        uint32_t id; // String indexes
+        uint32_t name;
+        uint32_t address;
+        uint32_t phone;
+        uint32_t firstAccount; // Into CUSTOMER_ACCOUNTS
+        uint32_t accountCount;
+    };
+
+    struct AccountRecord
+    {
+        uint32_t number; // String indexes
+        uint32_t owner;
+        int64_t balance;   // Minor units
+        int64_t parameter; // Interest rate ppm (savings) or overdraft limit (checking)
+        uint64_t firstTransaction;
+        uint64_t transactionCount;
+    };
+
+    // Builds the sections in memory and writes them out with one pass
+    class Writer
+    {
+    public:
+        Writer() : strings_(1, 0) {}
+
+        uint32_t addString(string_view value)
+        {
+            stringData_.insert(stringData_.end(), value.begin(), value.end());
+            strings_.push_back(stringData_.size());
+            return static_cast<uint32_t>(strings_.size() - 2);
+        }
+
+        template <typename T>
+        void add(Section section, const T &value)
+        {
+            vector<char> &bytes = sections_[section];
+            size_t at = bytes.size();
+            bytes.resize(at + sizeof(T));
+            memcpy(&bytes[at], &value, sizeof(T));
+        }
+
+        template <typename T>
+        void addAll(Section section, const vector<T> &values)
+        {
+            vector<char> &bytes = sections_[section];
+            size_t at = bytes.size();
+            bytes.resize(at + values.size() * sizeof(T));
+            if (!values.empty())
+            {
+                memcpy(&bytes[at], values.data(), values.size() * sizeof(T));
+            }
+        }
+
+        // header supplies the counts and walLsn; offsets and sizes are filled in here
+        void write(const string &path, Header header)
+        {
+            addAll(STRING_OFFSETS, strings_);
+            sections_[STRING_DATA] = stringData_;
+            memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.headerSize = sizeof(Header);
+            header.stringCount = strings_.size() - 1;
+            uint64_t offset = align(sizeof(Header));
+            for (int s = 0; s < SECTION_COUNT; ++s)
+            {
+                header.sectionOffsets[s] = offset;
+                offset = align(offset + sections_[s].size());
+            }
+            header.fileSize = offset;
+
+            // Written to a temporary name, synced and renamed, then the
+            // directory is synced: a crash at any point leaves either the
+            // previous snapshot or the complete new one under path
+            string temporary = path + ".tmp";
+            FILE *file = fopen(temporary.c_str(), "wb");
+            if (file == nullptr)
+            {
+                throw runtime_error("Unable to create snapshot " + temporary);
+            }
+            static const char padding[8] = {};
+            uint64_t written = fwrite(&header, 1, sizeof(Header), file);
+            for (int s = 0; s < SECTION_COUNT; ++s)
+            {
+                written += fwrite(padding, 1, header.sectionOffsets[s] - written, file);
+                written += fwrite(sections_[s].data(), 1, sections_[s].size(), file);
+            }
+            written += fwrite(padding, 1, header.fileSize - written, file);
+            bool ok = (written == header.fileSize) && fflush(file) == 0 && syncFile(file);
+            ok = (fclose(file) == 0) && ok;
+            if (!ok || rename(temporary.c_str(), path.c_str()) != 0)
+            {
+                remove(temporary.c_str());
+                throw runtime_error("Unable to write snapshot " + path);
+            }
+            if (!syncDirectoryOf(path))
+            {
+                throw runtime_error("Unable to sync the directory of snapshot " + path);
+            }
+        }
+
+    private:
+        static uint64_t align(uint64_t offset)
+        {
+            return (offset + 7) & ~uint64_t(7);
+        }
+
+        static bool syncFile(FILE *file)
+        {
+#ifdef _WIN32
+            return _commit(_fileno(file)) == 0;
+#else
+            return fsync(fileno(file)) == 0;
+#endif
+        }
+
+        // Makes the rename itself durable. Windows has no directory handle
+        // to sync; there the rename is left to the file system.
+        static bool syncDirectoryOf(const string &path)
+        {
+#ifdef _WIN32
+            (void)path;
+            return true;
+#else
+            size_t slash = path.find_last_of('/');
+            string directory = (slash == string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+            int fd = open(directory.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return false;
+            }
+            bool ok = fsync(fd) == 0;
+            return (close(fd) == 0) && ok;
+#endif
+        }
+
+        vector<char> sections_[SECTION_COUNT];
+        vector<uint64_t> strings_; // Offsets; strings_[i + 1] ends string i
+        vector<char> stringData_;
+    };
+
+    // Read-only mapping of a snapshot file with typed access to its sections
+    class View
+    {
+    public:
+        explicit View(const string &path)
+        {
+#ifdef _WIN32
+            ifstream in(path, ios::binary | ios::ate);
+            if (!in)
+            {
+                throw runtime_error("Unable to open snapshot " + path);
+            }
+            buffer_.resize(static_cast<size_t>(in.tellg()) / 8 + 1);
+            size_ = static_cast<size_t>(in.tellg());
+            in.seekg(0);
+            in.read(reinterpret_cast<char *>(buffer_.data()), size_);
+            data_ = reinterpret_cast<const char *>(buffer_.data());
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw runtime_error("Unable to open snapshot " + path);
+            }
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header)))
+            {
+                close(fd);
+                throw runtime_error("Snapshot " + path + " is truncated");
+            }
+            size_ = static_cast<size_t>(info.st_size);
+            void *mapped = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapped == MAP_FAILED)
+            {
+                throw runtime_error("Unable to map snapshot " + path);
+            }
+            data_ = static_cast<const char *>(mapped);
+#endif
+            validate(path);
+        }
+
+        View(const View &) = delete;
+        View &operator=(const View &) = delete;
+
+        ~View()
+        {
+#ifndef _WIN32
+            munmap(const_cast<char *>(data_), size_);
+#endif
+        }
+
+        const Header &header() const
+        {
+            return *reinterpret_cast<const Header *>(data_);
+        }
+
+        template <typename T>
+        const T *section(Section s) const
+        {
+            return reinterpret_cast<const T *>(data_ + header().sectionOffsets[s]);
+        }
+
+        string_view getString(uint32_t index) const
+        {
+            const uint64_t *offsets = section<uint64_t>(STRING_OFFSETS);
+            return string_view(section<char>(STRING_DATA) + offsets[index], offsets[index + 1] - offsets[index]);
+        }
+
+    private:
+        // Checks the header and that every section lies inside the file, so
+        // later reads cannot run off the mapping
+        void validate(const string &path) const
+        {
+            const Header &h = header();
+            if (size_ < sizeof(Header) || memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0)
+            {
+                throw runtime_error(path + " is not a bank snapshot");
+            }
+            if (h.version != VERSION || h.headerSize != sizeof(Header))
+            {
+                throw runtime_error("Unsupported snapshot version " + to_string(h.version) + " in " + path);
+            }
+            const uint64_t accounts = h.savingsCount + h.checkingCount;
+            const uint64_t n = h.transactionCount;
+            const uint64_t sizes[SECTION_COUNT] = {
+                h.customerCount * sizeof(CustomerRecord), h.customerAccountCount * sizeof(uint32_t),
+                accounts * sizeof(AccountRecord), n * 8, n * 8, n * 8, n * 4, n,
+                (h.stringCount + 1) * sizeof(uint64_t), 0};
+            for (int s = 0; s < SECTION_COUNT; ++s)
+            {
+                if (h.fileSize != size_ || h.sectionOffsets[s] % 8 != 0 || h.sectionOffsets[s] > size_ ||
+                    sizes[s] > size_ - h.sectionOffsets[s])
+                {
+                    throw runtime_error("Snapshot " + path + " is truncated or corrupt");
+                }
+            }
+            const uint64_t *offsets = section<uint64_t>(STRING_OFFSETS);
+            uint64_t dataSize = size_ - h.sectionOffsets[STRING_DATA];
+            for (uint64_t i = 0; i < h.stringCount; ++i)
+            {
+                if (offsets[i] > offsets[i + 1] || offsets[i + 1] > dataSize)
+                {
+                    throw runtime_error("Snapshot " + path + " has a corrupt string table");
+                }
+            }
+        }
+
+        const char *data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        vector<uint64_t> buffer_; // 8-byte aligned copy of the file
+#endif
+    };
+};
+
+constexpr char BankSnapshot::MAGIC[8];
+
+#endif // BANKSNAPSHOT
@@ -0,0 +1,268 @@
+#include <iostream>
+#include <cstdio>  // For printf
+#include <cstdlib> // For malloc, free
+#include <chrono>
+#include <atomic>
+#include <new>     // For bad_alloc
+#include <random>
+#include <string>
+#include <vector>
+#include "Bank.cpp"        // For Bank class
+#include "DataManager.cpp" // For DataManager singleton
+using namespace std;
+
+// Microbenchmarks for the core operations at several bank sizes. Results
+// go to stdout as one JSON document:
+//   {"benchmarks": [{"name", "accounts", "iterations", "ns_per_op",
+//                    "allocations_per_op", "ops_per_second"}, ...]}
+//
+// Usage: benchmark [--sizes=1000,100000,1000000] [--ops=200000]
+
+// --- Allocation counting ---
+// Every heap allocation in the process goes through these replacements.
+// They are kept out of line so GCC does not pair an inlined malloc with a
+// library delete and warn about a mismatch.
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+static atomic<long long> allocationCount(0);
+
+BENCH_NOINLINE void *operator new(size_t size)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+BENCH_NOINLINE void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+BENCH_NOINLINE void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void *p) noexcept
+{
+    free(p);
+}
+
+BENCH_NOINLINE void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+BENCH_NOINLINE void operator delete[](void *p, size_t) noexcept
+{
+    free(p);
+}
+
+struct BenchmarkResult
+{
+    string name;
+    size_t accounts;
+    long long iterations;
+    double nsPerOp;
+    double allocationsPerOp;
+    double opsPerSecond;
+};
+
+// Times body(i) for i in [0, iterations) after a short warm-up
+template <typename Body>
+BenchmarkResult measure(const string &name, size_t accounts, long long iterations, Body body)
+{
+    for (long long i = 0; i < iterations / 100; ++i)
+    {
+        body(i);
+    }
+    long long allocationsBefore = allocationCount.load();
+    auto start = chrono::steady_clock::now();
+    for (long long i = 0; i < iterations; ++i)
+    {
+        body(i);
+    }
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    long long allocations = allocationCount.load() - allocationsBefore;
+    return BenchmarkResult{name, accounts, iterations, ns / iterations,
+                           static_cast<double>(allocations) / iterations, iterations * 1e9 / ns};
+}
+
+// Runs every benchmark against a bank with accountCount accounts (half
+// savings, half checking, one of each per customer)
+void runSuite(size_t accountCount, long long ops, vector<BenchmarkResult> &results)
+{
+    DataManager &dataManager = DataManager::getInstance();
+    dataManager.setMinLevel(DataLogEntry::LogLevel::ERROR); // Setup and operations log nothing
+
+    Bank bank("Benchmark Bank");
+    vector<Account *> savings, checking;
+    vector<string> accountNumbers;
+    savings.reserve(accountCount / 2);
+    checking.reserve(accountCount / 2);
+    accountNumbers.reserve(accountCount);
+    for (size_t i = 0; i < accountCount / 2; ++i)
+    {
+        const Customer &customer = bank.createCustomer("Customer " + to_string(i), "1 Bench St", "555-0000");
+        Account &s = bank.createSavingsAccount(customer.getCustomerId(), Money::fromMinorUnits(100000000), InterestRate::fromDouble(0.001));
+        Account &c = bank.createCheckingAccount(customer.getCustomerId(), Money::fromMinorUnits(100000000), Money::fromMinorUnits(50000));
+        savings.push_back(&s);
+        checking.push_back(&c);
+        accountNumbers.push_back(s.getAccountNumber());
+        accountNumbers.push_back(c.getAccountNumber());
+    }
+
+    // Random picks are drawn up front so the timed loops only do the work
+    mt19937 random(42);
+    vector<uint32_t> pick(ops), pickOther(ops);
+    for (long long i = 0; i < ops; ++i)
+    {
+        pick[i] = static_cast<uint32_t>(random() % (accountCount / 2));
+        pickOther[i] = static_cast<uint32_t>(random() % accountCount);
+    }
+    const string description = "Benchmark";
+    const Money amount = Money::fromMinorUnits(125);
+
+    results.push_back(measure("account_deposit", accountCount, ops, [&](long long i)
+                              { savings[pick[i]]->deposit(amount, description); }));
+    results.push_back(measure("account_withdraw", accountCount, ops, [&](long long i)
+                              { savings[pick[i]]->withdraw(amount, description); }));
+    results.push_back(measure("checking_withdraw", accountCount, ops, [&](long long i)
+                              { checking[pick[i]]->withdraw(amount, description); }));
+    volatile size_t sink = 0;
+    results.push_back(measure("bank_get_account", accountCount, ops, [&](long long i)
+                              { sink = sink + (bank.getAccount(accountNumbers[pickOther[i]]) != nullptr); }));
+    results.push_back(measure("bank_transfer_funds", accountCount, ops, [&](long long i)
+                              { bank.transferFunds(accountNumbers[pickOther[i]], accountNumbers[pickOther[ops - 1 - i]], amount, description); }));
+
+    // One op is one account maintained; a run covers every account
+    long long runs = max<long long>(1, min<long long>(1000, ops / static_cast<long long>(accountCount)));
+    BenchmarkResult maintenance = measure("bank_run_monthly_maintenance", accountCount, runs, [&](long long)
+                                          { bank.runMonthlyMaintenance(); });
+    maintenance.iterations *= accountCount;
+    maintenance.nsPerOp /= accountCount;
+    maintenance.allocationsPerOp /= accountCount;
+    maintenance.opsPerSecond *= accountCount;
+    results.push_back(maintenance);
+
+    // The interest kernel alone over accountCount balance/rate pairs (one op
+    // is one account), against the one-call-per-account loop it replaces
+    vector<int64_t> balances(accountCount), rates(accountCount), interest(accountCount);
+    for (size_t i = 0; i < accountCount; ++i)
+    {
+        balances[i] = static_cast<int64_t>(random() % 100000000);
+        rates[i] = static_cast<int64_t>(random() % 50000);
+    }
+    long long kernelRuns = max<long long>(1, ops * 10 / static_cast<long long>(accountCount));
+    for (bool blocked : {true, false})
+    {
+        BenchmarkResult kernel = measure(blocked ? "ledger_compute_interest" : "ledger_compute_interest_scalar",
+                                         accountCount, kernelRuns, [&](long long)
+                                         {
+            if (blocked)
+            {
+                Ledger::computeInterest(balances.data(), rates.data(), interest.data(), accountCount);
+            }
+            else
+            {
+                Ledger::computeInterestScalar(balances.data(), rates.data(), interest.data(), accountCount);
+            } });
+        kernel.iterations *= accountCount;
+        kernel.nsPerOp /= accountCount;
+        kernel.allocationsPerOp /= accountCount;
+        kernel.opsPerSecond *= accountCount;
+        results.push_back(kernel);
+    }
+
+    // In lazy interest mode a month-end only closes the period (one op is
+    // one run); switching back settles the credits outside the timing
+    bank.setInterestMode(Bank::InterestMode::LAZY);
+    results.push_back(measure("bank_run_monthly_maintenance_lazy", accountCount, runs, [&](long long)
+                              { bank.runMonthlyMaintenance(); }));
+    bank.setInterestMode(Bank::InterestMode::EAGER);
+
+    // Logging with the level enabled (entries are kept, nothing is printed)
+    // and with it filtered out at runtime
+    dataManager.clearLogs();
+    dataManager.setMinLevel(DataLogEntry::LogLevel::INFO);
+    results.push_back(measure("datamanager_log_event", accountCount, ops, [&](long long i)
+                              { dataManager.logEvent<DataLogEntry::LogLevel::INFO>(
+                                    DataLogEntry::EventKind::DEPOSIT, accountNumbers[pickOther[i]], amount, amount); }));
+    dataManager.setMinLevel(DataLogEntry::LogLevel::ERROR);
+    dataManager.clearLogs();
+    results.push_back(measure("datamanager_log_event_filtered", accountCount, ops, [&](long long i)
+                              { dataManager.logEvent<DataLogEntry::LogLevel::INFO>(
+                                    DataLogEntry::EventKind::DEPOSIT, accountNumbers[pickOther[i]], amount, amount); }));
+}
+
+vector<size_t> parseSizes(const string &list)
+{
+    vector<size_t> sizes;
+    size_t start = 0;
+    while (start < list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == string::npos)
+        {
+            end = list.size();
+        }
+        sizes.push_back(stoull(list.substr(start, end - start)));
+        start = end + 1;
+    }
+    return sizes;
+}
+
+int main(int argc, char *argv[])
+{
+    vector<size_t> sizes = {1000, 100000, 1000000};
+    long long ops = 200000;
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        if (arg.compare(0, 8, "--sizes=") == 0)
+        {
+            sizes = parseSizes(arg.substr(8));
+        }
+        else if (arg.compare(0, 6, "--ops=") == 0)
+        {
+            ops = stoll(arg.substr(6));
+        }
+        else
+        {
+            cerr << "Usage: " << argv[0] << " [--sizes=1000,100000,1000000] [--ops=200000]\n";
+            return 2;
+        }
+    }
+
+    DataManager::getInstance().setSink(DataManager::LogSink::NONE); // Keep stdout pure JSON
+
+    vector<BenchmarkResult> results;
+    for (size_t size : sizes)
+    {
+        if (size < 2 || ops < 1)
+        {
+            cerr << "Sizes must be at least 2 and ops at least 1\n";
+            return 2;
+        }
+        runSuite(size, ops, results);
+    }
+
+    printf("{\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult &r = results[i];
+        printf("    {\"name\": \"%s\", \"accounts\": %zu, \"iterations\": %lld, \"ns_per_op\": %.2f, "
+               "\"allocations_per_op\": %.3f, \"ops_per_second\": %.0f}%s\n",
+               r.name.c_str(), r.accounts, r.iterations, r.nsPerOp, r.allocationsPerOp, r.opsPerSecond,
+               i + 1 < results.size() ? "," : "");
+    }
+    printf("  ]\n}\n");
+    return 0;
+}
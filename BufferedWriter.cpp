@@ -0,0 +1,251 @@
+#include <cstdint>
+#include <cstdio>       // For FILE
+#include <ctime>        // For time_t
+#include <stdexcept>    // For runtime_error
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Money.cpp"
+#include "TextFormat.cpp" // For in-place number and date formatting
+using namespace std;
+
+#ifndef BUFFEREDWRITER
+#define BUFFEREDWRITER
+
+// Writes text to a file through one large buffer, formatting numbers,
+// amounts and dates straight into it with TextFormat, so nothing is
+// allocated per record. Meant to be owned by one thread; bulk exporters
+// give each worker its own.
+class BufferedWriter
+{
+public:
+    explicit BufferedWriter(size_t capacity = 1 << 20) : buffer_(capacity < 256 ? 256 : capacity) {}
+
+    ~BufferedWriter()
+    {
+        if (file_ != nullptr)
+        {
+            flushBuffer();
+            fclose(file_);
+        }
+    }
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    // Closes the current file, if any, and starts writing to path
+    void open(const string &path)
+    {
+        close();
+        file_ = fopen(path.c_str(), "wb");
+        if (file_ == nullptr)
+        {
+            throw runtime_error("Unable to create " + path);
+        }
+        setvbuf(file_, nullptr, _IONBF, 0); // buffer_ already batches writes
+        path_ = path;
+        failed_ = false;
+    }
+
+    // Flushes and closes the current file; throws if any write failed
+    void close()
+    {
+        if (file_ == nullptr)
+        {
+            return;
+        }
+        flushBuffer();
+        bool ok = (fclose(file_) == 0) && !failed_;
+        file_ = nullptr;
+        if (!ok)
+        {
+            throw runtime_error("Unable to write " + path_);
+        }
+    }
+
+    BufferedWriter &write(string_view text)
+    {
+        if (text.size() > buffer_.size() - used_)
+        {
+            flushBuffer();
+            if (text.size() > buffer_.size())
+            {
+                writeToFile(text.data(), text.size());
+                return *this;
+            }
+        }
+        text.copy(buffer_.data() + used_, text.size());
+        used_ += text.size();
+        return *this;
+    }
+
+    BufferedWriter &put(char c)
+    {
+        reserve(1);
+        buffer_[used_++] = c;
+        return *this;
+    }
+
+    BufferedWriter &writeInt(int64_t value)
+    {
+        reserve(TextFormat::MAX_INT_CHARS);
+        used_ = offsetOf(TextFormat::appendInt(cursor(), value));
+        return *this;
+    }
+
+    // Same text as Money::toString, e.g. "-1234.56"
+    BufferedWriter &writeMoney(Money amount)
+    {
+        reserve(TextFormat::MAX_MONEY_CHARS);
+        used_ = offsetOf(TextFormat::appendMoney(cursor(), amount));
+        return *this;
+    }
+
+    // UTC "YYYY-MM-DD HH:MM:SS" (see TextFormat::appendDateTime). The text
+    // of the last timestamp is kept, since consecutive rows usually share a
+    // second.
+    BufferedWriter &writeDateTime(time_t timestamp, char separator = ' ')
+    {
+        if (timestamp != cachedTime_ || separator != cachedSeparator_ || cachedLength_ == 0)
+        {
+            cachedLength_ = static_cast<size_t>(TextFormat::appendDateTime(cachedText_, timestamp, separator) - cachedText_);
+            cachedTime_ = timestamp;
+            cachedSeparator_ = separator;
+        }
+        return write(string_view(cachedText_, cachedLength_));
+    }
+
+    // One CSV field (RFC 4180): quoted, with quotes doubled, only when it
+    // contains a comma, quote or line break
+    BufferedWriter &writeCsvField(string_view text)
+    {
+        bool needsQuotes = false;
+        for (char c : text)
+        {
+            needsQuotes |= (c == ',') | (c == '"') | (c == '\n') | (c == '\r');
+        }
+        if (!needsQuotes)
+        {
+            return write(text);
+        }
+        put('"');
+        for (size_t start = 0;;)
+        {
+            size_t quote = text.find('"', start);
+            write(text.substr(start, quote == string_view::npos ? string_view::npos : quote + 1 - start));
+            if (quote == string_view::npos)
+            {
+                break;
+            }
+            put('"');
+            start = quote + 1;
+        }
+        return put('"');
+    }
+
+    // A JSON string literal, quotes included. Runs of plain characters are
+    // copied as-is; bytes of 0x80 and up pass through, so UTF-8 stays valid.
+    BufferedWriter &writeJsonString(string_view text)
+    {
+        static const char HEX[] = "0123456789abcdef";
+        put('"');
+        size_t runStart = 0;
+        for (size_t i = 0; i < text.size(); ++i)
+        {
+            unsigned char c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+            {
+                continue;
+            }
+            write(text.substr(runStart, i - runStart));
+            runStart = i + 1;
+            reserve(6);
+            char *out = cursor();
+            *out++ = '\\';
+            switch (c)
+            {
+            case '"':
+                *out++ = '"';
+                break;
+            case '\\':
+                *out++ = '\\';
+                break;
+            case '\n':
+                *out++ = 'n';
+                break;
+            case '\r':
+                *out++ = 'r';
+                break;
+            case '\t':
+                *out++ = 't';
+                break;
+            default:
+                *out++ = 'u';
+                *out++ = '0';
+                *out++ = '0';
+                *out++ = HEX[c >> 4];
+                *out++ = HEX[c & 0xF];
+                break;
+            }
+            used_ = offsetOf(out);
+        }
+        write(text.substr(runStart));
+        return put('"');
+    }
+
+    // Bytes handed to write/put/... since construction, across all files
+    uint64_t getBytesWritten() const
+    {
+        return bytesFlushed_ + used_;
+    }
+
+private:
+    FILE *file_ = nullptr;
+    string path_;
+    bool failed_ = false;
+    vector<char> buffer_;
+    size_t used_ = 0;
+    uint64_t bytesFlushed_ = 0;
+    time_t cachedTime_ = 0;
+    char cachedSeparator_ = ' ';
+    size_t cachedLength_ = 0;
+    char cachedText_[TextFormat::MAX_DATETIME_CHARS];
+
+    char *cursor()
+    {
+        return buffer_.data() + used_;
+    }
+
+    size_t offsetOf(const char *end) const
+    {
+        return static_cast<size_t>(end - buffer_.data());
+    }
+
+    void reserve(size_t bytes)
+    {
+        if (buffer_.size() - used_ < bytes)
+        {
+            flushBuffer();
+        }
+    }
+
+    void flushBuffer()
+    {
+        if (used_ > 0)
+        {
+            writeToFile(buffer_.data(), used_);
+            used_ = 0;
+        }
+    }
+
+    void writeToFile(const char *data, size_t size)
+    {
+        if (file_ == nullptr || fwrite(data, 1, size, file_) != size)
+        {
+            failed_ = true;
+        }
+        bytesFlushed_ += size;
+    }
+};
+
+#endif // BUFFEREDWRITER
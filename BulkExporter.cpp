@@ -0,0 +1,312 @@
+#include <cstdint>
+#include <ctime>       // For time_t
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <type_traits> // For is_same
+#include <iterator>    // For size
+#include <vector>
+#include "Bank.cpp"
+#include "BufferedWriter.cpp"
+#include "LogStore.cpp"
+#include "TransactionJournal.cpp"
+using namespace std;
+
+#ifndef BULKEXPORTER
+#define BULKEXPORTER
+
+// Writes the transaction journal, log entries or an account listing to one
+// file as CSV (with a header row) or JSON Lines (one object per line).
+// Rows are formatted straight into a BufferedWriter: columns are copied out
+// of the journal a chunk at a time and interned strings are looked up once
+// per distinct value, so the export allocates nothing per row.
+//
+// Timestamps are written as ISO 8601 UTC ("2026-01-31T09:30:00Z") and
+// amounts as exact decimals ("-12.50"; unquoted numbers in JSON).
+class BulkExporter
+{
+public:
+    enum class Format
+    {
+        CSV,
+        JSONL
+    };
+
+    struct Result
+    {
+        size_t rowCount = 0;
+        uint64_t bytesWritten = 0;
+        double elapsedSeconds = 0.0;
+
+        double getBytesPerSecond() const
+        {
+            return elapsedSeconds > 0 ? bytesWritten / elapsedSeconds : 0.0;
+        }
+    };
+
+    explicit BulkExporter(Format format, size_t bufferBytes = 1 << 20) : format_(format), out_(bufferBytes) {}
+
+    // Every row of the TransactionJournal present when the export starts, in
+    // append order. Throws runtime_error if the file cannot be written.
+    Result exportTransactions(const string &path)
+    {
+        static const char *const COLUMNS[] = {"id", "timestamp", "type", "account", "amount", "description"};
+        const TransactionJournal &journal = TransactionJournal::getInstance();
+        Exporting run(*this, path, COLUMNS, size(COLUMNS));
+        const size_t rowCount = journal.size();
+        ids_.resize(JOURNAL_CHUNK);
+        timestamps_.resize(JOURNAL_CHUNK);
+        types_.resize(JOURNAL_CHUNK);
+        amounts_.resize(JOURNAL_CHUNK);
+        accountIds_.resize(JOURNAL_CHUNK);
+        descriptionIds_.resize(JOURNAL_CHUNK);
+        for (size_t first = 0; first < rowCount; first += JOURNAL_CHUNK)
+        {
+            const size_t count = min(JOURNAL_CHUNK, rowCount - first);
+            journal.readRange(first, count, ids_.data(), timestamps_.data(), types_.data(), amounts_.data(),
+                              accountIds_.data(), descriptionIds_.data());
+            for (size_t i = 0; i < count; ++i)
+            {
+                writeNumber(ids_[i]);
+                writeTime(static_cast<time_t>(timestamps_[i]));
+                writeText(Transaction::getTypeName(static_cast<Transaction::Type>(types_[i])));
+                writeText(interned(accountNames_, accountIds_[i], &TransactionJournal::getAccountNumber));
+                writeAmount(Money::fromMinorUnits(amounts_[i]));
+                writeText(interned(descriptions_, descriptionIds_[i], &TransactionJournal::getDescription));
+                endRow();
+            }
+        }
+        return run.finish(rowCount);
+    }
+
+    // The entries of a log view (e.g. DataManager::queryLogs). Structured
+    // entries are written as their typed fields; description is filled only
+    // for plain MESSAGE entries, so nothing has to be rendered.
+    Result exportLogs(const string &path, const LogView &logs)
+    {
+        static const char *const COLUMNS[] = {"id", "timestamp", "level", "kind", "account", "related",
+                                              "amount", "balance", "interest_rate_ppm", "note", "description"};
+        Exporting run(*this, path, COLUMNS, size(COLUMNS));
+        for (const DataLogEntry &entry : logs)
+        {
+            const bool message = entry.getKind() == DataLogEntry::EventKind::MESSAGE;
+            writeNumber(entry.getEntryId());
+            writeTime(entry.getTimestamp());
+            writeText(DataLogEntry::getLevelName(entry.getLevel()));
+            writeText(DataLogEntry::getKindName(entry.getKind()));
+            writeText(entry.getAccountNumber());
+            writeText(entry.getRelatedId());
+            writeAmount(entry.getAmount());
+            writeAmount(entry.getBalance());
+            if (entry.getKind() == DataLogEntry::EventKind::SAVINGS_ACCOUNT_CREATED)
+            {
+                writeNumber(entry.getInterestRate().getPartsPerMillion());
+            }
+            else
+            {
+                writeNull();
+            }
+            writeText(entry.getNote());
+            writeText(message ? string_view(entry.getDescription()) : string_view());
+            endRow();
+        }
+        return run.finish(logs.size());
+    }
+
+    // One row per open account, savings then checking, with its balance
+    // (including lazily accrued interest, which is settled first) and
+    // transaction count taken together under the account lock. The rate and
+    // limit columns are empty (null) for the other account type.
+    Result exportAccounts(const string &path, const Bank &bank)
+    {
+        static const char *const COLUMNS[] = {"account", "kind", "owner", "balance", "transactions",
+                                              "interest_rate_ppm", "overdraft_limit"};
+        Exporting run(*this, path, COLUMNS, size(COLUMNS));
+        size_t rowCount = 0;
+        auto writeAccount = [&](auto &account)
+        {
+            using AccountType = decay_t<decltype(account)>;
+            Money balance;
+            size_t transactionCount = 0;
+            {
+                unique_lock<mutex> guard = account.lock();
+                account.settleInterestUnlocked();
+                balance = account.getBalanceUnlocked();
+                transactionCount = account.getTransactionHistory().size();
+            }
+            writeText(account.getAccountNumber());
+            writeText(Account::getKindName(account.getKind()));
+            writeText(account.getOwnerId());
+            writeAmount(balance);
+            writeNumber(static_cast<int64_t>(transactionCount));
+            if constexpr (is_same<AccountType, SavingsAccount>::value)
+            {
+                writeNumber(account.getInterestRate().getPartsPerMillion());
+                writeNull();
+            }
+            else
+            {
+                writeNull();
+                writeAmount(account.getOverdraftLimit());
+            }
+            endRow();
+            ++rowCount;
+        };
+        bank.forEachAccount(writeAccount);
+        return run.finish(rowCount);
+    }
+
+private:
+    static const size_t JOURNAL_CHUNK = 4096; // Rows copied out of the journal per lock
+
+    // Opens the file and writes the CSV header for one export; finish()
+    // closes it and fills in the totals. Closes quietly if an export throws.
+    class Exporting
+    {
+    public:
+        Exporting(BulkExporter &exporter, const string &path, const char *const *columns, size_t columnCount)
+            : exporter_(exporter), start_(chrono::steady_clock::now()), startBytes_(exporter.out_.getBytesWritten())
+        {
+            exporter_.out_.open(path);
+            exporter_.column_ = 0;
+            exporter_.fieldPrefixes_.assign(columnCount, string());
+            for (size_t i = 0; i < columnCount; ++i)
+            {
+                string &prefix = exporter_.fieldPrefixes_[i];
+                if (exporter_.format_ == Format::CSV)
+                {
+                    prefix = (i == 0) ? "" : ",";
+                    exporter_.out_.write(prefix).write(columns[i]);
+                }
+                else
+                {
+                    prefix = string(i == 0 ? "{\"" : ",\"") + columns[i] + "\":";
+                }
+            }
+            if (exporter_.format_ == Format::CSV)
+            {
+                exporter_.out_.put('\n');
+            }
+        }
+
+        ~Exporting()
+        {
+            if (!finished_)
+            {
+                try
+                {
+                    exporter_.out_.close();
+                }
+                catch (const exception &)
+                {
+                    // Already unwinding from the export's own error
+                }
+            }
+        }
+
+        Exporting(const Exporting &) = delete;
+        Exporting &operator=(const Exporting &) = delete;
+
+        Result finish(size_t rowCount)
+        {
+            finished_ = true;
+            exporter_.out_.close();
+            Result result;
+            result.rowCount = rowCount;
+            result.bytesWritten = exporter_.out_.getBytesWritten() - startBytes_;
+            result.elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start_).count();
+            return result;
+        }
+
+    private:
+        BulkExporter &exporter_;
+        chrono::steady_clock::time_point start_;
+        uint64_t startBytes_;
+        bool finished_ = false;
+    };
+
+    Format format_;
+    BufferedWriter out_;
+    vector<string> fieldPrefixes_; // Separator, plus the key in JSON Lines, per column
+    size_t column_ = 0;            // Next column of the current row
+
+    // Journal scratch columns and interned-string caches, reused across rows
+    vector<int64_t> ids_;
+    vector<int64_t> timestamps_;
+    vector<uint8_t> types_;
+    vector<int64_t> amounts_;
+    vector<uint32_t> accountIds_;
+    vector<uint32_t> descriptionIds_;
+    vector<const string *> accountNames_;
+    vector<const string *> descriptions_;
+
+    // Interned string id, fetched from the journal on first use only
+    static const string &interned(vector<const string *> &cache, uint32_t id,
+                                  const string &(TransactionJournal::*lookup)(uint32_t) const)
+    {
+        if (id >= cache.size())
+        {
+            cache.resize(id + 1, nullptr);
+        }
+        if (cache[id] == nullptr)
+        {
+            cache[id] = &(TransactionJournal::getInstance().*lookup)(id);
+        }
+        return *cache[id];
+    }
+
+    // Separator and, for JSON Lines, the key of the next column
+    void beginField()
+    {
+        out_.write(fieldPrefixes_[column_++]);
+    }
+
+    void endRow()
+    {
+        out_.write(format_ == Format::CSV ? "\n" : "}\n");
+        column_ = 0;
+    }
+
+    void writeText(string_view text)
+    {
+        beginField();
+        if (format_ == Format::CSV)
+        {
+            out_.writeCsvField(text);
+        }
+        else
+        {
+            out_.writeJsonString(text);
+        }
+    }
+
+    void writeNumber(int64_t value)
+    {
+        beginField();
+        out_.writeInt(value);
+    }
+
+    void writeAmount(Money amount)
+    {
+        beginField();
+        out_.writeMoney(amount);
+    }
+
+    void writeTime(time_t timestamp)
+    {
+        beginField();
+        const char *quote = (format_ == Format::JSONL) ? "\"" : "";
+        out_.write(quote).writeDateTime(timestamp, 'T').write(format_ == Format::JSONL ? "Z\"" : "Z");
+    }
+
+    void writeNull()
+    {
+        beginField();
+        if (format_ == Format::JSONL)
+        {
+            out_.write("null");
+        }
+    }
+};
+
+#endif // BULKEXPORTER
@@ -6,59 +6,83 @@ using namespace std;
 #ifndef CHECKINGACCOUNT
 #define CHECKINGACCOUNT
 
-class CheckingAccount : public Account
+class CheckingAccount final : public Account
 {
 public:
-    CheckingAccount(const string &ownerId, double initialBalance, double overdraftLimit)
+    CheckingAccount(const string &ownerId, Money initialBalance, Money overdraftLimit)
         : Account(ownerId, initialBalance), overdraftLimit_(overdraftLimit)
     {
-        DataManager::getInstance().logEvent(
-            DataLogEntry::LogLevel::INFO,
-            "CheckingAccount created: " + accountNumber_ + " for owner " + ownerId_ + " with overdraft limit $" + to_string(overdraftLimit_));
+        kind_ = Kind::CHECKING;
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::CHECKING_ACCOUNT_CREATED, accountNumber_, overdraftLimit_, Money(), ownerId_);
     }
 
-    double getOverdraftLimit() const
+    CheckingAccount(RestoreTag tag, const string &accountNumber, const string &ownerId, Money balance, Money overdraftLimit)
+        : Account(tag, accountNumber, ownerId, balance), overdraftLimit_(overdraftLimit)
+    {
+        kind_ = Kind::CHECKING;
+    }
+
+    Money getOverdraftLimit() const
     {
         return overdraftLimit_;
     }
 
-    // Override base class withdraw for overdraft logic
-    bool withdraw(double amount, const string &description) override
+    bool canWithdraw(Money amount) const override
+    {
+        return amount > Money() && balance_ + overdraftLimit_ >= amount;
+    }
+
+    // Override base class withdraw for overdraft logic; caller holds lock()
+    bool withdrawUnlocked(Money amount, const string &description) override
     {
-        if (amount <= 0)
+        if (amount <= Money())
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::WARNING,
-                "Withdrawal failed for " + accountNumber_ + ": Invalid amount $" + to_string(amount));
+            reportWithdrawalRejected(amount);
             return false;
         }
 
+        settleInterestUnlocked();
+
         // Check if withdrawal exceeds balance plus overdraft limit
-        if (balance_ + overdraftLimit_ < amount)
+        if (!canWithdraw(amount))
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::WARNING,
-                "Withdrawal failed for " + accountNumber_ + ": Exceeds overdraft limit. Attempted: $" + to_string(amount) +
-                    ", Available (with overdraft): $" + to_string(balance_ + overdraftLimit_));
+            reportWithdrawalRejected(amount);
             return false;
         }
 
-        balance_ -= amount;
+        adjustBalance(-amount);
         addTransaction(Transaction::Type::WITHDRAWAL, amount, description);
+        reportWithdrawal(amount);
+        return true;
+    }
+
+    void reportWithdrawalRejected(Money amount) const override
+    {
+        if (amount <= Money())
+        {
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::WARNING>(
+                DataLogEntry::EventKind::WITHDRAWAL_INVALID_AMOUNT, accountNumber_, amount);
+            return;
+        }
+        Metrics::getInstance().increment(Metrics::Counter::OVERDRAFT_LIMIT_EXCEEDED);
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::WARNING>(
+            DataLogEntry::EventKind::OVERDRAFT_LIMIT_EXCEEDED, accountNumber_, amount, balance_ + overdraftLimit_);
+    }
 
-        if (balance_ < 0)
+    void reportWithdrawal(Money amount) const override
+    {
+        if (balance_ < Money())
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::WARNING,
-                "Overdraft incurred for " + accountNumber_ + ". New balance: $" + to_string(balance_));
+            Metrics::getInstance().increment(Metrics::Counter::OVERDRAFTS_INCURRED);
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::WARNING>(
+                DataLogEntry::EventKind::OVERDRAFT_INCURRED, accountNumber_, Money(), balance_);
         }
         else
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::INFO,
-                "Withdrew $" + to_string(amount) + " from " + accountNumber_ + ". New balance: $" + to_string(balance_));
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+                DataLogEntry::EventKind::WITHDRAWAL, accountNumber_, amount, balance_);
         }
-        return true;
     }
 
     // Override pure virtual function from base class
@@ -66,13 +90,12 @@ public:
     {
         // No specific monthly maintenance for CheckingAccount in this basic model,
         // but this method exists for extensibility (e.g., overdraft fees)
-        DataManager::getInstance().logEvent(
-            DataLogEntry::LogLevel::INFO,
-            "Performed monthly maintenance for CheckingAccount " + accountNumber_);
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::CHECKING_MAINTENANCE, accountNumber_);
     }
 
 private:
-    double overdraftLimit_;
+    Money overdraftLimit_;
 };
 
 #endif // CHECKINGACCOUNT
\ No newline at end of file
@@ -1,14 +1,16 @@
 #include <chrono> // For timestamp
 #include <ctime>  // For time_t
 #include <map>
-#include <iomanip>
 #include <iostream>
 #include <string>
 #include <vector>
+#include <deque>     // For CustomerRange
+#include <algorithm> // For find
 #include <atomic>  // For unique ID generation
 #include <ostream> // For ostream
 
 #include "DataManager.cpp"    // For logging
+#include "IdSequence.cpp"     // For unique ID generation
 #include "Account.cpp"        // For Account class
 #include "InvalidAccount.cpp" // For InvalidAccount singleton
 using namespace std;
@@ -16,6 +18,9 @@ using namespace std;
 #ifndef CUSTOMER
 #define CUSTOMER
 
+// A Bank's customer. Customers live in the Bank's storage for the Bank's
+// whole lifetime and are handed out by reference; they are move-only so a
+// stray by-value copy (which would miss later changes) does not compile.
 class Customer
 {
 
@@ -27,17 +32,31 @@ public:
     }
 
     Customer(const string &name, const string &address, const string &phone)
-        : customerId_("CUS" + to_string(nextCustomerId++)),
+        : customerId_("CUS" + to_string(nextCustomerId.next())),
           name_(name),
           address_(address),
           phone_(phone)
     {
-        DataManager::getInstance().logEvent(
-            DataLogEntry::LogLevel::INFO,
-            "Customer created: " + customerId_ + " (" + name_ + ")");
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::CUSTOMER_CREATED, string(), Money(), Money(), customerId_, name_);
     }
 
-    string getCustomerId() const
+    // Rebuilds a customer with a known ID (WAL replay) without logging
+    static Customer restore(const string &customerId, const string &name, const string &address, const string &phone)
+    {
+        if (customerId.compare(0, 3, "CUS") == 0 && customerId.size() > 3)
+        {
+            nextCustomerId.advancePast(stoll(customerId.substr(3)));
+        }
+        return Customer(customerId, name, address, phone);
+    }
+
+    Customer(Customer &&) = default;
+    Customer &operator=(Customer &&) = default;
+    Customer(const Customer &) = delete;
+    Customer &operator=(const Customer &) = delete;
+
+    const string &getCustomerId() const
     {
         return customerId_;
     }
@@ -57,14 +76,19 @@ public:
         return phone_;
     }
 
+    // addAccount without the log line, for accounts being restored
+    void addRestoredAccount(Account *account)
+    {
+        accounts_.push_back(account);
+    }
+
     void addAccount(Account *account)
     {
-        if (*account == *(InvalidAccount::getInstance()))
+        if (account != nullptr && !(*account == *(InvalidAccount::getInstance())))
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::INFO,
-                "Account " + account->getAccountNumber() + " added to customer " + customerId_);
-            accounts_.push_back(account); // Transfer ownership
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+                DataLogEntry::EventKind::ACCOUNT_ADDED_TO_CUSTOMER, account->getAccountNumber(), Money(), Money(), customerId_);
+            accounts_.push_back(account);
         }
         else
         {
@@ -74,7 +98,20 @@ public:
         }
     }
 
-    const vector<Account *> getAccounts() const
+    // Drops a closed account from this customer's list
+    void removeAccount(const Account *account)
+    {
+        auto it = find(accounts_.begin(), accounts_.end(), account);
+        if (it != accounts_.end())
+        {
+            accounts_.erase(it);
+        }
+    }
+
+    // Changes when the Bank adds or closes one of this customer's accounts
+    // (hold the Bank's directory lock, e.g. inside Bank::withCustomers, in
+    // thread-safe mode)
+    const vector<Account *> &getAccounts() const
     {
         return accounts_;
     }
@@ -101,7 +138,7 @@ public:
            << "  Accounts (" << customer.getAccounts().size() << "): \n";
         for (Account *acc : customer.getAccounts())
         {
-            os << "    - " << acc->getAccountNumber() << " (Balance: $" << fixed << setprecision(2) << acc->getBalance() << ")\n";
+            os << "    - " << acc->getAccountNumber() << " (Balance: $" << acc->getBalance() << ")\n";
         }
         return os;
     }
@@ -112,12 +149,12 @@ public:
     }
 
 private:
-    static int nextCustomerId;
+    static IdSequence nextCustomerId;
     string customerId_;
     string name_;
     string address_;
     string phone_;
-    vector<Account *> accounts_; // Customer owns their accounts
+    vector<Account *> accounts_; // Owned by the Bank's account pools
 
     Customer(const string &customerID, const string &name, const string &address, const string &phone)
         : customerId_(customerID),
@@ -126,7 +163,49 @@ private:
           phone_(phone) {}
 };
 
+// Read-only view over a Bank's customers in registration order, as of when
+// it was taken. Customers never move, so references from it stay valid for
+// the Bank's lifetime; iterating it while another thread registers a
+// customer does not, so in thread-safe mode use it inside
+// Bank::withCustomers.
+class CustomerRange
+{
+public:
+    using const_iterator = deque<Customer>::const_iterator;
+
+    explicit CustomerRange(const deque<Customer> &customers) : customers_(&customers), size_(customers.size()) {}
+
+    const_iterator begin() const
+    {
+        return customers_->begin();
+    }
+
+    const_iterator end() const
+    {
+        return customers_->begin() + static_cast<ptrdiff_t>(size_);
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    const Customer &operator[](size_t index) const
+    {
+        return (*customers_)[index];
+    }
+
+private:
+    const deque<Customer> *customers_;
+    size_t size_;
+};
+
 // Initialize the static atomic counter
-int Customer::nextCustomerId(10000); // Start customer IDs from 10000
+IdSequence Customer::nextCustomerId(10000); // Start customer IDs from 10000
 
 #endif // CUSTOMER
\ No newline at end of file
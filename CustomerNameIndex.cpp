@@ -0,0 +1,104 @@
+#include <cstddef>
+#include <functional>  // For less<>
+#include <map>         // For the ordered name index
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Customer.cpp"
+using namespace std;
+
+#ifndef CUSTOMERNAMEINDEX
+#define CUSTOMERNAMEINDEX
+
+// Ordered index of customers by case-folded name, for exact and type-ahead
+// (prefix) search in O(log n + k). Names are folded to ASCII lower case;
+// other bytes, including UTF-8 sequences, compare as-is. Customers sharing a
+// folded name stay in registration order. Case-sensitive queries walk the
+// folded range and keep only exact-case matches.
+// Not synchronized; Bank guards it with the directory lock.
+class CustomerNameIndex
+{
+public:
+    enum class CaseMode
+    {
+        SENSITIVE,
+        INSENSITIVE
+    };
+
+    static string fold(string_view name)
+    {
+        string folded(name);
+        for (char &c : folded)
+        {
+            if (c >= 'A' && c <= 'Z')
+            {
+                c = static_cast<char>(c - 'A' + 'a');
+            }
+        }
+        return folded;
+    }
+
+    // customer must stay at the same address for the index's lifetime.
+    // multimap inserts after existing equal keys, keeping registration order.
+    void add(const Customer &customer)
+    {
+        byFoldedName_.emplace(fold(customer.getName()), &customer);
+    }
+
+    // First registered customer with exactly this name, or nullptr
+    const Customer *findFirst(const string &name) const
+    {
+        auto range = byFoldedName_.equal_range(fold(name));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second->getName() == name)
+            {
+                return it->second;
+            }
+        }
+        return nullptr;
+    }
+
+    // Every customer with this name, in registration order
+    vector<const Customer *> findByName(const string &name, CaseMode mode) const
+    {
+        vector<const Customer *> matches;
+        auto range = byFoldedName_.equal_range(fold(name));
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (mode == CaseMode::INSENSITIVE || it->second->getName() == name)
+            {
+                matches.push_back(it->second);
+            }
+        }
+        return matches;
+    }
+
+    // Up to limit customers whose name starts with prefix, ordered by folded
+    // name and then registration
+    vector<const Customer *> findByPrefix(const string &prefix, CaseMode mode, size_t limit) const
+    {
+        vector<const Customer *> matches;
+        const string foldedPrefix = fold(prefix);
+        for (auto it = byFoldedName_.lower_bound(foldedPrefix);
+             it != byFoldedName_.end() && matches.size() < limit && it->first.compare(0, foldedPrefix.size(), foldedPrefix) == 0;
+             ++it)
+        {
+            if (mode == CaseMode::INSENSITIVE || it->second->getName().compare(0, prefix.size(), prefix) == 0)
+            {
+                matches.push_back(it->second);
+            }
+        }
+        return matches;
+    }
+
+    size_t size() const
+    {
+        return byFoldedName_.size();
+    }
+
+private:
+    multimap<string, const Customer *, less<>> byFoldedName_;
+};
+
+#endif // CUSTOMERNAMEINDEX
@@ -1,9 +1,11 @@
-#include <map>    // For mapping enum to string
+#include <cstddef> // For size_t
 #include <chrono> // For timestamp
 #include <ctime>  // For time_t
 #include <string>
 #include <ostream> // For ostream
 #include <atomic>  // For unique ID generation
+#include <mutex>   // For rendering shared entries
+#include "Money.cpp" // For exact amounts
 using namespace std;
 
 #ifndef DATALOGENTRY
@@ -19,8 +21,74 @@ public:
         ERROR
     };
 
+    // What happened. MESSAGE entries carry a preformatted description; every
+    // other kind keeps its typed fields and renders the text on first read.
+    enum class EventKind
+    {
+        MESSAGE,
+        ACCOUNT_CREATED, // account, related = owner, amount = initial balance
+        SAVINGS_ACCOUNT_CREATED, // account, related = owner, rate
+        CHECKING_ACCOUNT_CREATED, // account, related = owner, amount = overdraft limit
+        DEPOSIT, // account, amount, balance
+        DEPOSIT_INVALID_AMOUNT, // account, amount
+        WITHDRAWAL, // account, amount, balance
+        WITHDRAWAL_FAILED, // account, amount, balance
+        WITHDRAWAL_INVALID_AMOUNT, // account, amount
+        OVERDRAFT_LIMIT_EXCEEDED, // account, amount, balance = available with overdraft
+        OVERDRAFT_INCURRED, // account, balance
+        INTEREST_APPLIED, // account, amount, balance
+        INTEREST_FAILED, // account
+        CHECKING_MAINTENANCE, // account
+        TRANSFER_COMPLETED, // account = source, related = destination, amount, note
+        TRANSFER_INVALID_AMOUNT, // amount
+        TRANSFER_SOURCE_NOT_FOUND, // account = source
+        TRANSFER_DESTINATION_NOT_FOUND, // account = destination
+        TRANSFER_WITHDRAWAL_FAILED, // account = source, related = destination
+        CUSTOMER_CREATED, // related = customer, note = name
+        ACCOUNT_ADDED_TO_CUSTOMER // account, related = customer
+    };
+    static const size_t EVENT_KIND_COUNT = 21;
+
+    static constexpr const char *getLevelName(LogLevel level)
+    {
+        constexpr const char *names[] = {"INFO", "WARNING", "ERROR"};
+        return names[static_cast<size_t>(level)];
+    }
+
+    static constexpr const char *getKindName(EventKind kind)
+    {
+        constexpr const char *names[EVENT_KIND_COUNT] = {
+            "MESSAGE", "ACCOUNT_CREATED", "SAVINGS_ACCOUNT_CREATED", "CHECKING_ACCOUNT_CREATED", "DEPOSIT",
+            "DEPOSIT_INVALID_AMOUNT", "WITHDRAWAL", "WITHDRAWAL_FAILED", "WITHDRAWAL_INVALID_AMOUNT",
+            "OVERDRAFT_LIMIT_EXCEEDED", "OVERDRAFT_INCURRED", "INTEREST_APPLIED", "INTEREST_FAILED",
+            "CHECKING_MAINTENANCE", "TRANSFER_COMPLETED", "TRANSFER_INVALID_AMOUNT", "TRANSFER_SOURCE_NOT_FOUND",
+            "TRANSFER_DESTINATION_NOT_FOUND", "TRANSFER_WITHDRAWAL_FAILED", "CUSTOMER_CREATED",
+            "ACCOUNT_ADDED_TO_CUSTOMER"};
+        return names[static_cast<size_t>(kind)];
+    }
+
     DataLogEntry(LogLevel level, const string &description)
-        : entryId_(nextId++), timestamp_(), level_(level), description_(description) {}
+        : entryId_(nextId++), timestamp_(time(nullptr)), level_(level), kind_(EventKind::MESSAGE),
+          description_(description, true) {}
+
+    DataLogEntry(LogLevel level, EventKind kind, const string &accountNumber, Money amount, Money balance,
+                 const string &relatedId, const string &note, InterestRate rate)
+        : entryId_(nextId++), timestamp_(time(nullptr)), level_(level), kind_(kind),
+          accountNumber_(accountNumber), relatedId_(relatedId), note_(note),
+          amount_(amount), balance_(balance), rate_(rate), description_(string(), false) {}
+
+    // Tag for the constructor that rebuilds a stored entry (log segments read
+    // back from disk): ID and timestamp are given and nextId is untouched
+    struct RestoreTag
+    {
+    };
+
+    DataLogEntry(RestoreTag, long long entryId, time_t timestamp, LogLevel level, EventKind kind,
+                 const string &accountNumber, Money amount, Money balance, const string &relatedId,
+                 const string &note, InterestRate rate, const string &description)
+        : entryId_(entryId), timestamp_(timestamp), level_(level), kind_(kind),
+          accountNumber_(accountNumber), relatedId_(relatedId), note_(note),
+          amount_(amount), balance_(balance), rate_(rate), description_(description, kind == EventKind::MESSAGE) {}
 
     long getEntryId() const
     {
@@ -36,35 +104,182 @@ public:
         return level_;
     }
 
+    EventKind getKind() const
+    {
+        return kind_;
+    }
+
+    const string &getAccountNumber() const
+    {
+        return accountNumber_;
+    }
+
+    const string &getRelatedId() const
+    {
+        return relatedId_;
+    }
+
+    const string &getNote() const
+    {
+        return note_;
+    }
+
+    Money getAmount() const
+    {
+        return amount_;
+    }
+
+    Money getBalance() const
+    {
+        return balance_;
+    }
+
+    InterestRate getInterestRate() const
+    {
+        return rate_;
+    }
+
+    // Structured entries are formatted here, the first time the text is
+    // needed. Safe to call from several threads on the same entry.
     const string &getDescription() const
     {
-        return description_;
+        if (!description_.ready.load(memory_order_acquire))
+        {
+            lock_guard<mutex> lock(renderMutex());
+            if (!description_.ready.load(memory_order_relaxed))
+            {
+                description_.text = render();
+                description_.ready.store(true, memory_order_release);
+            }
+        }
+        return description_.text;
     }
 
     // Overload stream insertion operator for easy printing
     friend ostream &operator<<(ostream &os, const DataLogEntry &entry)
     {
-        map<DataLogEntry::LogLevel, string> logLevelMap = {
-            {DataLogEntry::LogLevel::INFO, "INFO"},
-            {DataLogEntry::LogLevel::WARNING, "WARNING"},
-            {DataLogEntry::LogLevel::ERROR, "ERROR"}};
-
         os << "[" << entry.getTimestamp() << "] "
-           << "[" << logLevelMap[entry.getLevel()] << "] "
+           << "[" << getLevelName(entry.getLevel()) << "] "
            << "(ID:" << entry.getEntryId() << ") "
            << entry.getDescription();
         return os;
     }
 
 private:
+    // Description text plus whether it has been rendered yet. Copies take
+    // the render lock when the source may be rendering concurrently.
+    struct LazyDescription
+    {
+        string text;
+        atomic<bool> ready;
+
+        LazyDescription(const string &initial, bool isReady) : text(initial), ready(isReady) {}
+
+        LazyDescription(const LazyDescription &other) : ready(false)
+        {
+            *this = other;
+        }
+
+        LazyDescription &operator=(const LazyDescription &other)
+        {
+            if (other.ready.load(memory_order_acquire))
+            {
+                text = other.text;
+                ready.store(true, memory_order_release);
+            }
+            else
+            {
+                lock_guard<mutex> lock(renderMutex());
+                text = other.text;
+                ready.store(other.ready.load(memory_order_relaxed), memory_order_release);
+            }
+            return *this;
+        }
+
+        // Moves only happen to entries no other thread can see
+        LazyDescription(LazyDescription &&other) noexcept
+            : text(move(other.text)), ready(other.ready.load(memory_order_relaxed)) {}
+
+        LazyDescription &operator=(LazyDescription &&other) noexcept
+        {
+            text = move(other.text);
+            ready.store(other.ready.load(memory_order_relaxed), memory_order_relaxed);
+            return *this;
+        }
+    };
+
+    static mutex &renderMutex()
+    {
+        static mutex instance;
+        return instance;
+    }
+
     // Initialize the static atomic counter
-    static int nextId; // For unique ID generation
+    static atomic<long long> nextId; // For unique ID generation; DataManager creates entries under its lock
     long long entryId_;
     time_t timestamp_;
     LogLevel level_;
-    string description_;
+    EventKind kind_;
+    string accountNumber_;
+    string relatedId_; // Owner or counterparty, depending on kind_
+    string note_;
+    Money amount_;
+    Money balance_;
+    InterestRate rate_;
+    mutable LazyDescription description_; // Rendered text, filled lazily for structured entries
+
+    string render() const
+    {
+        switch (kind_)
+        {
+        case EventKind::ACCOUNT_CREATED:
+            return "Account created: " + accountNumber_ + " for owner " + relatedId_ + " with initial balance $" + amount_.toString();
+        case EventKind::SAVINGS_ACCOUNT_CREATED:
+            return "SavingsAccount created: " + accountNumber_ + " for owner " + relatedId_ + " with interest rate " + rate_.toString();
+        case EventKind::CHECKING_ACCOUNT_CREATED:
+            return "CheckingAccount created: " + accountNumber_ + " for owner " + relatedId_ + " with overdraft limit $" + amount_.toString();
+        case EventKind::DEPOSIT:
+            return "Deposited $" + amount_.toString() + " into " + accountNumber_ + ". New balance: $" + balance_.toString();
+        case EventKind::DEPOSIT_INVALID_AMOUNT:
+            return "Deposit failed for " + accountNumber_ + ": Invalid amount $" + amount_.toString();
+        case EventKind::WITHDRAWAL:
+            return "Withdrew $" + amount_.toString() + " from " + accountNumber_ + ". New balance: $" + balance_.toString();
+        case EventKind::WITHDRAWAL_FAILED:
+            return "Withdrawal failed for " + accountNumber_ + ": Invalid amount $" + amount_.toString() + " or insufficient funds. Current balance: $" + balance_.toString();
+        case EventKind::WITHDRAWAL_INVALID_AMOUNT:
+            return "Withdrawal failed for " + accountNumber_ + ": Invalid amount $" + amount_.toString();
+        case EventKind::OVERDRAFT_LIMIT_EXCEEDED:
+            return "Withdrawal failed for " + accountNumber_ + ": Exceeds overdraft limit. Attempted: $" + amount_.toString() +
+                   ", Available (with overdraft): $" + balance_.toString();
+        case EventKind::OVERDRAFT_INCURRED:
+            return "Overdraft incurred for " + accountNumber_ + ". New balance: $" + balance_.toString();
+        case EventKind::INTEREST_APPLIED:
+            return "Interest of $" + amount_.toString() + " applied to SavingsAccount " + accountNumber_ + ". New balance: $" + balance_.toString();
+        case EventKind::INTEREST_FAILED:
+            return "Failed to apply interest to SavingsAccount " + accountNumber_;
+        case EventKind::CHECKING_MAINTENANCE:
+            return "Performed monthly maintenance for CheckingAccount " + accountNumber_;
+        case EventKind::TRANSFER_COMPLETED:
+            return "Successfully transferred $" + amount_.toString() + " from " + accountNumber_ + " to " + relatedId_ + (note_.empty() ? "" : " (" + note_ + ")");
+        case EventKind::TRANSFER_INVALID_AMOUNT:
+            return "Transfer failed: Invalid amount $" + amount_.toString();
+        case EventKind::TRANSFER_SOURCE_NOT_FOUND:
+            return "Transfer failed: Source account " + accountNumber_ + " not found.";
+        case EventKind::TRANSFER_DESTINATION_NOT_FOUND:
+            return "Transfer failed: Destination account " + accountNumber_ + " not found.";
+        case EventKind::TRANSFER_WITHDRAWAL_FAILED:
+            return "Transfer failed between " + accountNumber_ + " and " + relatedId_ + " due to withdrawal issue.";
+        case EventKind::CUSTOMER_CREATED:
+            return "Customer created: " + relatedId_ + " (" + note_ + ")";
+        case EventKind::ACCOUNT_ADDED_TO_CUSTOMER:
+            return "Account " + accountNumber_ + " added to customer " + relatedId_;
+        case EventKind::MESSAGE:
+        default:
+            return description_.text;
+        }
+    }
 };
 
-int DataLogEntry::nextId = 10001; // Initialize static member variable
+atomic<long long> DataLogEntry::nextId(10001); // Initialize static member variable
 
 #endif // DATALOGENTRY
\ No newline at end of file
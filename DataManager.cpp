@@ -1,19 +1,210 @@
 #include <iostream>
+#include <fstream> // For the file sink
 #include <vector>
+#include <deque> // For the async writer queue
 #include <string>
+#include <mutex>              // For thread-safe logging
+#include <condition_variable> // For the async writer queue
+#include <thread>             // For the async writer thread
+#include <atomic>
+#include <stdexcept>          // For runtime_error
+#include <sstream>            // For the metrics report
 #include "DataLogEntry.cpp"
+#include "LogStore.cpp"         // For indexed log storage
+#include "Metrics.cpp"        // For operation metrics
 using namespace std;
 
 #ifndef DATAMANAGER
 #define DATAMANAGER
 
+// Structured events below this level are compiled out of logEvent<Level>():
+// 0 = INFO (keep everything), 1 = WARNING, 2 = ERROR, 3 = none
+#ifndef BANK_LOG_COMPILE_MIN_LEVEL
+#define BANK_LOG_COMPILE_MIN_LEVEL 0
+#endif
+
 // DataManager will be a Singleton to ensure consistent logging
 class DataManager
 {
+public:
+    // Where formatted log lines are written
+    enum class LogSink
+    {
+        CONSOLE,
+        FILE,
+        NONE
+    };
+
+    // What an async producer does when the queue is full
+    enum class OverflowPolicy
+    {
+        BLOCK,         // Wait for the writer to make room
+        DROP,          // Discard the entry silently
+        DROP_AND_COUNT // Discard the entry and report the count on flush()
+    };
+
 private:
-    vector<DataLogEntry> logs_;
+    mutable mutex logsMutex_;
+    LogStore logs_{logsMutex_}; // Guarded by logsMutex_
+    atomic<int> minLevel_{0}; // Runtime threshold, compared against LogLevel values
+
+    // Sink state; only touched by the thread that writes (the caller in sync
+    // mode, the writer thread in async mode) and by setSink under sinkMutex_
+    mutex sinkMutex_;
+    LogSink sink_ = LogSink::CONSOLE;
+    atomic<bool> sinkEnabled_{true}; // sink_ != NONE, readable without sinkMutex_
+    ofstream file_;
+
+    // Async mode: bounded queue drained in batches by writerThread_
+    atomic<bool> async_{false};
+    size_t queueCapacity_ = 0;
+    size_t batchSize_ = 0;
+    OverflowPolicy overflowPolicy_ = OverflowPolicy::BLOCK;
+    deque<DataLogEntry> queue_; // deque so taking a batch off the front does not shift the rest
+    mutex queueMutex_;
+    condition_variable queueNotEmpty_;
+    condition_variable queueNotFull_;
+    condition_variable queueDrained_;
+    bool stopWriter_ = false;
+    bool writerBusy_ = false;
+    size_t droppedCount_ = 0;        // Entries dropped under DROP_AND_COUNT since the last flush
+    atomic<size_t> totalDropped_{0}; // Entries dropped under DROP or DROP_AND_COUNT overall
+    thread writerThread_;
+
     DataManager() {}
 
+    ~DataManager()
+    {
+        disableAsync();
+    }
+
+    // Writes a batch of entries to the current sink with a single flush
+    void writeToSink(const DataLogEntry *entries, size_t count)
+    {
+        lock_guard<mutex> lock(sinkMutex_);
+        if (sink_ == LogSink::NONE || count == 0)
+        {
+            return;
+        }
+        ostream &out = (sink_ == LogSink::FILE) ? static_cast<ostream &>(file_) : cout;
+        for (size_t i = 0; i < count; ++i)
+        {
+            out << "LOG: " << entries[i] << '\n';
+        }
+        out.flush();
+    }
+
+    void writeDropNotice(size_t dropped)
+    {
+        lock_guard<mutex> lock(sinkMutex_);
+        if (sink_ == LogSink::NONE || dropped == 0)
+        {
+            return;
+        }
+        ostream &out = (sink_ == LogSink::FILE) ? static_cast<ostream &>(file_) : cout;
+        out << "LOG: " << dropped << " log entries dropped (async queue full)" << endl;
+    }
+
+    void writerLoop()
+    {
+        vector<DataLogEntry> batch;
+        batch.reserve(batchSize_);
+        unique_lock<mutex> lock(queueMutex_);
+        while (true)
+        {
+            queueNotEmpty_.wait(lock, [this]
+                                { return stopWriter_ || !queue_.empty(); });
+            if (queue_.empty())
+            {
+                break; // stopWriter_ with nothing left to write
+            }
+
+            // Take at most batchSize_ entries so producers blocked on a full
+            // queue get room back before the write completes
+            size_t take = min(batchSize_, queue_.size());
+            batch.assign(make_move_iterator(queue_.begin()), make_move_iterator(queue_.begin() + take));
+            queue_.erase(queue_.begin(), queue_.begin() + take);
+            writerBusy_ = true;
+            lock.unlock();
+            queueNotFull_.notify_all();
+
+            writeToSink(batch.data(), batch.size());
+            batch.clear();
+
+            lock.lock();
+            writerBusy_ = false;
+            if (queue_.empty())
+            {
+                queueDrained_.notify_all();
+            }
+        }
+        writerBusy_ = false;
+        queueDrained_.notify_all();
+    }
+
+    // Appends an entry built from args and hands a copy to the sink
+    template <typename... Args>
+    void record(Args &&...args)
+    {
+        // Entries are created under the lock so IDs follow the order of logs_
+        unique_lock<mutex> logsLock(logsMutex_);
+        const DataLogEntry &stored = logs_.append(forward<Args>(args)...);
+        if (!sinkEnabled_)
+        {
+            return;
+        }
+        DataLogEntry entry = stored;
+        logsLock.unlock();
+
+        if (!async_)
+        {
+            // Optionally print to console for immediate feedback
+            writeToSink(&entry, 1);
+            return;
+        }
+
+        unique_lock<mutex> lock(queueMutex_);
+        if (!async_)
+        {
+            // Async mode was switched off since the check above
+            lock.unlock();
+            writeToSink(&entry, 1);
+            return;
+        }
+        if (queue_.size() >= queueCapacity_)
+        {
+            if (overflowPolicy_ == OverflowPolicy::BLOCK)
+            {
+                queueNotFull_.wait(lock, [this]
+                                   { return queue_.size() < queueCapacity_ || !async_; });
+                if (!async_)
+                {
+                    // The writer may already have exited
+                    lock.unlock();
+                    writeToSink(&entry, 1);
+                    return;
+                }
+            }
+            else
+            {
+                ++totalDropped_;
+                if (overflowPolicy_ == OverflowPolicy::DROP_AND_COUNT)
+                {
+                    ++droppedCount_;
+                }
+                return;
+            }
+        }
+        bool wasEmpty = queue_.empty();
+        queue_.push_back(move(entry));
+        Metrics::getInstance().record(Metrics::Histogram::LOG_QUEUE_DEPTH, queue_.size());
+        lock.unlock();
+        if (wasEmpty)
+        {
+            queueNotEmpty_.notify_one();
+        }
+    }
+
 public:
     static DataManager &getInstance()
     {
@@ -21,22 +212,257 @@ public:
         return instance;
     }
 
+    DataManager(const DataManager &) = delete;
+    DataManager &operator=(const DataManager &) = delete;
+
+    // Selects where formatted entries go. A FILE sink appends to filePath.
+    void setSink(LogSink sink, const string &filePath = "")
+    {
+        flush();
+        lock_guard<mutex> lock(sinkMutex_);
+        if (file_.is_open())
+        {
+            file_.close();
+        }
+        if (sink == LogSink::FILE)
+        {
+            file_.open(filePath, ios::out | ios::app);
+            if (!file_)
+            {
+                throw runtime_error("Unable to open log file " + filePath);
+            }
+        }
+        sink_ = sink;
+        sinkEnabled_ = (sink != LogSink::NONE);
+    }
+
+    // Switches to async mode: logEvent only queues the entry and a background
+    // thread writes queued entries to the sink in batches of up to batchSize.
+    void enableAsync(size_t queueCapacity = 8192, size_t batchSize = 256,
+                     OverflowPolicy policy = OverflowPolicy::BLOCK)
+    {
+        disableAsync();
+        lock_guard<mutex> lock(queueMutex_);
+        queueCapacity_ = max<size_t>(queueCapacity, 1);
+        batchSize_ = max<size_t>(batchSize, 1);
+        overflowPolicy_ = policy;
+        stopWriter_ = false;
+        async_ = true;
+        writerThread_ = thread(&DataManager::writerLoop, this);
+    }
+
+    // Drains the queue, stops the writer thread and returns to sync mode
+    void disableAsync()
+    {
+        {
+            lock_guard<mutex> lock(queueMutex_);
+            if (!async_)
+            {
+                return;
+            }
+            // Cleared together with stopWriter_ so no producer queues an
+            // entry after the writer has seen the queue empty and exited
+            async_ = false;
+            stopWriter_ = true;
+        }
+        queueNotEmpty_.notify_all();
+        queueNotFull_.notify_all();
+        writerThread_.join();
+        lock_guard<mutex> lock(queueMutex_);
+        writeDropNotice(droppedCount_);
+        droppedCount_ = 0;
+    }
+
+    bool isAsync() const
+    {
+        return async_;
+    }
+
+    // Blocks until every entry queued so far has been written to the sink.
+    // Call before shutdown or before reading a FILE sink.
+    void flush()
+    {
+        size_t dropped = 0;
+        {
+            unique_lock<mutex> lock(queueMutex_);
+            if (async_)
+            {
+                queueDrained_.wait(lock, [this]
+                                   { return queue_.empty() && !writerBusy_; });
+            }
+            dropped = droppedCount_;
+            droppedCount_ = 0;
+        }
+        writeDropNotice(dropped);
+    }
+
+    // Number of entries discarded by the DROP and DROP_AND_COUNT policies
+    size_t getDroppedCount() const
+    {
+        return totalDropped_;
+    }
+
+    // Entries below this level are discarded before anything is recorded
+    void setMinLevel(DataLogEntry::LogLevel level)
+    {
+        minLevel_.store(static_cast<int>(level), memory_order_relaxed);
+    }
+
+    bool isEnabled(DataLogEntry::LogLevel level) const
+    {
+        return static_cast<int>(level) >= minLevel_.load(memory_order_relaxed);
+    }
+
     void logEvent(DataLogEntry::LogLevel level, const string &description)
     {
-        logs_.emplace_back(level, description);
-        // Optionally print to console for immediate feedback
-        cout << "LOG: " << logs_.back() << endl;
+        if (isEnabled(level))
+        {
+            record(level, description);
+        }
+    }
+
+    // Structured event: the typed fields are stored as-is and the description
+    // is only rendered when the entry is printed or read. Events below
+    // BANK_LOG_COMPILE_MIN_LEVEL compile to nothing; events below the runtime
+    // minimum return before any copy is made.
+    template <DataLogEntry::LogLevel Level>
+    void logEvent(DataLogEntry::EventKind kind, const string &accountNumber,
+                  Money amount = Money(), Money balance = Money(),
+                  const string &relatedId = string(), const string &note = string(),
+                  InterestRate rate = InterestRate())
+    {
+        if constexpr (static_cast<int>(Level) >= BANK_LOG_COMPILE_MIN_LEVEL)
+        {
+            if (isEnabled(Level))
+            {
+                record(Level, kind, accountNumber, amount, balance, relatedId, note, rate);
+            }
+        }
     }
 
     vector<DataLogEntry> getAllLogs() const
     {
-        return logs_; // Returns a copy of the logs
+        LogView view = getLogs();
+        vector<DataLogEntry> all; // Returns a copy of the logs
+        all.reserve(view.size());
+        for (const DataLogEntry &entry : view)
+        {
+            all.push_back(entry);
+        }
+        return all;
+    }
+
+    // --- Log queries ---
+    // Views read the stored entries in place instead of copying them, and
+    // cover the entries logged before the call.
+    LogView queryLogs(const LogQuery &query) const
+    {
+        LogView view;
+        {
+            lock_guard<mutex> lock(logsMutex_);
+            view = logs_.query(query);
+        }
+        LogStore::completeQuery(view, query); // Reads spilled segments without the lock
+        return view;
+    }
+
+    LogView getLogs() const
+    {
+        return queryLogs(LogQuery());
+    }
+
+    LogView getLogsByLevel(DataLogEntry::LogLevel level) const
+    {
+        LogQuery query;
+        query.level = level;
+        return queryLogs(query);
+    }
+
+    // Entries whose account or related ID (owner, counterparty) is id
+    LogView getLogsFor(const string &id) const
+    {
+        LogQuery query;
+        query.relatedTo = id;
+        return queryLogs(query);
+    }
+
+    // Inclusive range of timestamps
+    LogView getLogsBetween(time_t from, time_t to) const
+    {
+        LogQuery query;
+        query.fromTime = from;
+        query.toTime = to;
+        return queryLogs(query);
+    }
+
+    size_t getLogCount() const
+    {
+        lock_guard<mutex> lock(logsMutex_);
+        return logs_.size();
+    }
+
+    // Bounds the memory held by log history: older segments are spilled to
+    // retention.directory and optionally deleted by age or total size (see
+    // LogRetention). Queries and views read spilled entries transparently.
+    void setLogRetention(const LogRetention &retention)
+    {
+        lock_guard<mutex> lock(logsMutex_);
+        logs_.setRetention(retention);
+    }
+
+    // Entries still held in memory or on disk
+    size_t getRetainedLogCount() const
+    {
+        lock_guard<mutex> lock(logsMutex_);
+        return logs_.getRetainedCount();
+    }
+
+    // Segments that could not be spilled (disk full, directory gone) and are
+    // kept in memory instead
+    size_t getFailedLogSpillCount() const
+    {
+        lock_guard<mutex> lock(logsMutex_);
+        return logs_.getFailedSpillCount();
+    }
+
+    // Waits until segments due to be spilled have been written out
+    void flushLogSpills()
+    {
+        unique_lock<mutex> lock(logsMutex_);
+        logs_.waitForSpills(lock);
     }
 
     void clearLogs()
     {
+        lock_guard<mutex> lock(logsMutex_);
         logs_.clear();
     }
+
+    // --- Metrics ---
+    // Counters and latency histograms recorded by accounts, the bank and the
+    // async queue (see Metrics.cpp). Off by default.
+    void setMetricsEnabled(bool enabled)
+    {
+        Metrics::getInstance().setEnabled(enabled);
+    }
+
+    Metrics::Snapshot getMetrics() const
+    {
+        return Metrics::getInstance().snapshot();
+    }
+
+    // getMetrics() as text, one metric per line
+    string getMetricsReport() const
+    {
+        ostringstream out;
+        out << getMetrics();
+        return out.str();
+    }
+
+    void resetMetrics()
+    {
+        Metrics::getInstance().reset();
+    }
 };
 
-#endif // DATAMANAGER
\ No newline at end of file
+#endif // DATAMANAGER
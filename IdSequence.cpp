@@ -0,0 +1,78 @@
+#include <atomic> // For the shared counter
+#include <cstddef>
+#include <stdexcept> // For logic_error
+using namespace std;
+
+#ifndef IDSEQUENCE
+#define IDSEQUENCE
+
+// Thread-safe ID generator. Each thread reserves a block of IDs from a
+// shared atomic counter and hands them out locally, so the counter is only
+// touched once per block. A single thread sees consecutive IDs starting at
+// the initial value; with several threads, IDs are unique but interleave by
+// block.
+class IdSequence
+{
+public:
+    static const size_t MAX_SEQUENCES = 16;
+
+    IdSequence(long long initialValue, long long blockSize = 64)
+        : next_(initialValue), blockSize_(blockSize), slot_(nextSlot_++)
+    {
+        if (slot_ >= MAX_SEQUENCES)
+        {
+            throw logic_error("Too many IdSequence instances");
+        }
+    }
+
+    IdSequence(const IdSequence &) = delete;
+    IdSequence &operator=(const IdSequence &) = delete;
+
+    long long next()
+    {
+        Block &block = blocks_[slot_];
+        if (block.owner != this || block.next == block.end)
+        {
+            block.owner = this;
+            block.next = next_.fetch_add(blockSize_, memory_order_relaxed);
+            block.end = block.next + blockSize_;
+        }
+        return block.next++;
+    }
+
+    // Makes sure later IDs are greater than value, e.g. after IDs were
+    // restored from disk. Drops the calling thread's cached block; call it
+    // before other threads start taking IDs.
+    void advancePast(long long value)
+    {
+        long long current = next_.load();
+        while (current <= value && !next_.compare_exchange_weak(current, value + 1))
+        {
+        }
+        Block &block = blocks_[slot_];
+        if (block.owner == this)
+        {
+            block.next = block.end;
+        }
+    }
+
+private:
+    struct Block
+    {
+        const IdSequence *owner = nullptr;
+        long long next = 0;
+        long long end = 0;
+    };
+
+    atomic<long long> next_;
+    const long long blockSize_;
+    const size_t slot_;
+
+    static atomic<size_t> nextSlot_;
+    static thread_local Block blocks_[MAX_SEQUENCES];
+};
+
+atomic<size_t> IdSequence::nextSlot_(0);
+thread_local IdSequence::Block IdSequence::blocks_[IdSequence::MAX_SEQUENCES];
+
+#endif // IDSEQUENCE
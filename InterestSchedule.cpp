@@ -0,0 +1,68 @@
+#include <cstddef>
+#include <cstdint>
+#include <ctime>  // For time_t
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+using namespace std;
+
+#ifndef INTERESTSCHEDULE
+#define INTERESTSCHEDULE
+
+// The month-ends a Bank has closed in lazy interest mode. Each one is a
+// numbered period with the journal timestamp of its close; an account that
+// has been settled up to period p owes interest for periods p..count-1 and
+// posts it, stamped with those times, the next time it is touched.
+// Periods are only closed under the Bank's directory lock; accounts read
+// the count without locking and the timestamps under a shared lock.
+class InterestSchedule
+{
+public:
+    uint64_t getPeriodCount() const
+    {
+        return periodCount_.load(memory_order_acquire);
+    }
+
+    // Close time of period, which must be between getFirstKnownPeriod() and
+    // getPeriodCount()
+    time_t getPeriodEnd(uint64_t period) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return periodEnds_[static_cast<size_t>(period - firstKnownPeriod_)];
+    }
+
+    // Periods before this one were closed before a snapshot load; every
+    // account has been settled past them
+    uint64_t getFirstKnownPeriod() const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return firstKnownPeriod_;
+    }
+
+    void closePeriod(time_t end)
+    {
+        {
+            unique_lock<shared_mutex> lock(mutex_);
+            periodEnds_.push_back(end);
+        }
+        periodCount_.fetch_add(1, memory_order_release);
+    }
+
+    // Snapshot load: periodCount periods have been closed and settled
+    void restore(uint64_t periodCount)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        periodEnds_.clear();
+        firstKnownPeriod_ = periodCount;
+        periodCount_.store(periodCount, memory_order_release);
+    }
+
+private:
+    mutable shared_mutex mutex_; // Guards periodEnds_ and firstKnownPeriod_
+    atomic<uint64_t> periodCount_{0};
+    uint64_t firstKnownPeriod_ = 0;
+    vector<time_t> periodEnds_; // Close time of each period from firstKnownPeriod_ on
+};
+
+#endif // INTERESTSCHEDULE
@@ -10,17 +10,17 @@ class InvalidAccount : public Account
 {
 private:
     InvalidAccount()
-        : Account("Invalid", 0)
+        : Account("Invalid", Money())
     {
         accountNumber_ = "-9999"; // Special invalid account number
+        journalAccountId_ = TransactionJournal::getInstance().internAccount(accountNumber_);
     }
 
 public:
     static Account* getInstance()
     {
-        static InvalidAccount instance = InvalidAccount(); // Guaranteed to be destroyed, instantiated on first use.
-        static Account account = (Account)instance;
-        return &account;
+        static InvalidAccount instance; // Guaranteed to be destroyed, instantiated on first use.
+        return &instance;
     }
 
     // Override pure virtual function from base class
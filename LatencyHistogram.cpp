@@ -0,0 +1,206 @@
+#include <cstdint>
+#include <cmath>     // For ceil
+#include <algorithm> // For min, max
+#include <vector>
+#include <atomic>
+#include <memory>    // For unique_ptr
+using namespace std;
+
+#ifndef LATENCYHISTOGRAM
+#define LATENCYHISTOGRAM
+
+// HDR-style latency histogram over nanosecond values. Values below 128 get
+// their own bucket; above that every power of two is split into 64 equal
+// sub-buckets, so any recorded value is reported within 1/64 (about 1.6%)
+// of its true value, from nanoseconds to hours, in a fixed 30 KB of counts.
+// Not synchronized: keep one per thread and merge() them afterwards, or use
+// AtomicLatencyHistogram when another thread reads while recording goes on.
+class LatencyHistogram
+{
+    friend class AtomicLatencyHistogram;
+
+public:
+    LatencyHistogram() : counts_(BUCKET_COUNT, 0) {}
+
+    void record(uint64_t nanoseconds)
+    {
+        ++counts_[bucketOf(nanoseconds)];
+        ++count_;
+        sum_ += nanoseconds;
+        min_ = min(min_, nanoseconds);
+        max_ = max(max_, nanoseconds);
+    }
+
+    void merge(const LatencyHistogram &other)
+    {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        min_ = min(min_, other.min_);
+        max_ = max(max_, other.max_);
+    }
+
+    void reset()
+    {
+        fill(counts_.begin(), counts_.end(), 0);
+        count_ = 0;
+        sum_ = 0;
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+
+    uint64_t getCount() const
+    {
+        return count_;
+    }
+
+    uint64_t getMin() const
+    {
+        return count_ == 0 ? 0 : min_;
+    }
+
+    uint64_t getMax() const
+    {
+        return max_;
+    }
+
+    double getMean() const
+    {
+        return count_ == 0 ? 0.0 : static_cast<double>(sum_) / count_;
+    }
+
+    // Smallest value v such that at least percentile% of recordings are
+    // <= v, reported as the top of v's bucket (capped at the maximum seen)
+    uint64_t getValueAtPercentile(double percentile) const
+    {
+        if (count_ == 0)
+        {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(ceil(percentile / 100.0 * count_));
+        target = max<uint64_t>(1, min(target, count_));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i)
+        {
+            seen += counts_[i];
+            if (seen >= target)
+            {
+                return min(highestInBucket(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    static const unsigned SUB_BUCKET_BITS = 6; // 64 sub-buckets per power of two
+    static const uint64_t SUB_BUCKETS = uint64_t(1) << SUB_BUCKET_BITS;
+    static const size_t BUCKET_COUNT = SUB_BUCKETS * (65 - SUB_BUCKET_BITS); // Covers every uint64_t
+
+    // Values below 2 * SUB_BUCKETS map to themselves; a larger value with
+    // its highest bit at position b is shifted right by b - SUB_BUCKET_BITS
+    // and offset by SUB_BUCKETS per shift, which keeps indexes contiguous
+    static size_t bucketOf(uint64_t value)
+    {
+        if (value < 2 * SUB_BUCKETS)
+        {
+            return static_cast<size_t>(value);
+        }
+#if defined(__GNUC__)
+        unsigned highestBit = 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+        unsigned highestBit = SUB_BUCKET_BITS + 1;
+        while ((value >> (highestBit + 1)) != 0)
+        {
+            ++highestBit;
+        }
+#endif
+        unsigned shift = highestBit - SUB_BUCKET_BITS;
+        return static_cast<size_t>(SUB_BUCKETS * shift + (value >> shift));
+    }
+
+    static uint64_t highestInBucket(size_t bucket)
+    {
+        if (bucket < 2 * SUB_BUCKETS)
+        {
+            return bucket;
+        }
+        unsigned shift = static_cast<unsigned>(bucket / SUB_BUCKETS) - 1;
+        uint64_t subBucket = bucket - SUB_BUCKETS * shift;
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    vector<uint64_t> counts_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+// Single-writer LatencyHistogram that other threads may read at any time.
+// The owning thread records with relaxed loads and stores (no locked
+// read-modify-write), so a reader sees a possibly slightly stale but never
+// torn view. Only one thread may call record().
+class AtomicLatencyHistogram
+{
+public:
+    AtomicLatencyHistogram() : counts_(new atomic<uint64_t>[LatencyHistogram::BUCKET_COUNT])
+    {
+        reset();
+    }
+
+    void record(uint64_t value)
+    {
+        bump(counts_[LatencyHistogram::bucketOf(value)], 1);
+        bump(sum_, value);
+        if (value < min_.load(memory_order_relaxed))
+        {
+            min_.store(value, memory_order_relaxed);
+        }
+        if (value > max_.load(memory_order_relaxed))
+        {
+            max_.store(value, memory_order_relaxed);
+        }
+    }
+
+    // Adds everything recorded so far to target
+    void addTo(LatencyHistogram &target) const
+    {
+        for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i)
+        {
+            uint64_t count = counts_[i].load(memory_order_relaxed);
+            target.counts_[i] += count;
+            target.count_ += count;
+        }
+        target.sum_ += sum_.load(memory_order_relaxed);
+        target.min_ = min(target.min_, min_.load(memory_order_relaxed));
+        target.max_ = max(target.max_, max_.load(memory_order_relaxed));
+    }
+
+    // Not exact if the owner records at the same time
+    void reset()
+    {
+        for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i)
+        {
+            counts_[i].store(0, memory_order_relaxed);
+        }
+        sum_.store(0, memory_order_relaxed);
+        min_.store(UINT64_MAX, memory_order_relaxed);
+        max_.store(0, memory_order_relaxed);
+    }
+
+private:
+    static void bump(atomic<uint64_t> &value, uint64_t amount)
+    {
+        value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+
+    unique_ptr<atomic<uint64_t>[]> counts_;
+    atomic<uint64_t> sum_{0};
+    atomic<uint64_t> min_{UINT64_MAX};
+    atomic<uint64_t> max_{0};
+};
+
+#endif // LATENCYHISTOGRAM
@@ -0,0 +1,129 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bank.cpp"
+#include "LatencyHistogram.cpp"
+#include "WorkloadGenerator.cpp"
+using namespace std;
+
+#ifndef LOADDRIVER
+#define LOADDRIVER
+
+// Runs a workload trace against a Bank on several threads and records the
+// latency of every operation, per operation type. Op i of the trace goes to
+// thread i % threadCount, so each thread's sequence is fixed by the trace;
+// with one thread a replay is fully deterministic.
+//
+// Closed loop (targetRate 0): each thread issues its next op as soon as the
+// previous one returns. Open loop: op i is due at start + i / targetRate and
+// its latency is measured from that due time, so time spent queued behind a
+// slow operation counts (no coordinated omission).
+class LoadDriver
+{
+public:
+    struct Options
+    {
+        unsigned threadCount = 1;
+        double targetRate = 0.0; // Ops per second across all threads; 0 = closed loop
+    };
+
+    struct Result
+    {
+        double elapsedSeconds = 0.0;
+        size_t operationCount = 0;
+        LatencyHistogram latency[WorkloadOp::TYPE_COUNT];
+        size_t failed[WorkloadOp::TYPE_COUNT] = {};
+    };
+
+    // accountNumbers[i] is the account a trace index i refers to
+    LoadDriver(Bank &bank, const vector<string> &accountNumbers)
+        : bank_(bank), accountNumbers_(accountNumbers)
+    {
+        // Resolved once, so deposits and withdrawals skip the number lookup
+        accountHandles_.reserve(accountNumbers.size());
+        for (const string &number : accountNumbers)
+        {
+            accountHandles_.push_back(bank.getAccountHandle(number));
+        }
+    }
+
+    Result run(const vector<WorkloadOp> &trace, const Options &options)
+    {
+        const unsigned threadCount = max(1u, options.threadCount);
+        vector<Result> perThread(threadCount);
+        const auto start = chrono::steady_clock::now() + chrono::milliseconds(1); // Lets every thread start
+        auto worker = [&](unsigned t)
+        {
+            Result &result = perThread[t];
+            for (size_t i = t; i < trace.size(); i += threadCount)
+            {
+                auto issued = start;
+                if (options.targetRate > 0.0)
+                {
+                    issued += chrono::duration_cast<chrono::steady_clock::duration>(
+                        chrono::duration<double>(i / options.targetRate));
+                    this_thread::sleep_until(issued);
+                }
+                else
+                {
+                    issued = chrono::steady_clock::now();
+                }
+                bool ok = execute(trace[i]);
+                auto done = chrono::steady_clock::now();
+                size_t type = static_cast<size_t>(trace[i].type);
+                result.latency[type].record(static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(done - issued).count()));
+                result.failed[type] += ok ? 0 : 1;
+            }
+        };
+        vector<thread> workers;
+        for (unsigned t = 1; t < threadCount; ++t)
+        {
+            workers.emplace_back(worker, t);
+        }
+        worker(0);
+        for (thread &w : workers)
+        {
+            w.join();
+        }
+
+        Result total;
+        total.elapsedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        total.operationCount = trace.size();
+        for (const Result &r : perThread)
+        {
+            for (size_t k = 0; k < WorkloadOp::TYPE_COUNT; ++k)
+            {
+                total.latency[k].merge(r.latency[k]);
+                total.failed[k] += r.failed[k];
+            }
+        }
+        return total;
+    }
+
+private:
+    // Returns false when the bank rejects the operation
+    bool execute(const WorkloadOp &op)
+    {
+        const Money amount = Money::fromMinorUnits(op.amount);
+        switch (op.type)
+        {
+        case WorkloadOp::Type::DEPOSIT:
+            return bank_.getAccount(accountHandles_[op.account])->deposit(amount, "Load deposit");
+        case WorkloadOp::Type::WITHDRAWAL:
+        case WorkloadOp::Type::OVERDRAFT_ATTEMPT:
+            return bank_.getAccount(accountHandles_[op.account])->withdraw(amount, "Load withdrawal");
+        case WorkloadOp::Type::TRANSFER:
+            return bank_.transferFunds(accountNumbers_[op.account], accountNumbers_[op.otherAccount], amount, "Load transfer");
+        default:
+            bank_.runMonthlyMaintenance();
+            return true;
+        }
+    }
+
+    Bank &bank_;
+    const vector<string> &accountNumbers_;
+    vector<Bank::AccountHandle> accountHandles_;
+};
+
+#endif // LOADDRIVER
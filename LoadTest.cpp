@@ -0,0 +1,341 @@
+#include <iostream>
+#include <cstdio> // For printf, remove
+#include <filesystem> // For the default --wal path
+#include <string>
+#include <vector>
+#include "Bank.cpp"        // For Bank class
+#include "DataManager.cpp" // For DataManager singleton
+#include "LoadDriver.cpp"  // For running traces
+#include "StatementExporter.cpp" // For --export-statements
+#include "BulkExporter.cpp"      // For --export
+using namespace std;
+
+// Load driver: builds a bank, generates (or loads) a workload trace and
+// runs it, then prints per-operation latency percentiles as JSON. The same
+// --accounts with a saved trace and --threads=1 reproduces a run exactly;
+// compare balance_checksum to confirm.
+
+void printUsage(const char *program)
+{
+    cerr << "Usage: " << program << " [options]\n"
+         << "  --accounts=N            accounts in the bank, half savings and half checking (default 100000)\n"
+         << "  --ops=N                 operations to generate (default 1000000)\n"
+         << "  --threads=N             driver threads (default 1)\n"
+         << "  --rate=R                open loop at R ops/s in total; 0 = closed loop (default 0)\n"
+         << "  --zipf=S                Zipf exponent for account popularity (default 0.99)\n"
+         << "  --mix=D,W,T,O           weights of deposits, withdrawals, transfers, overdraft attempts (default 40,30,25,5)\n"
+         << "  --maintenance-every=N   run monthly maintenance after every N ops; 0 = never (default 0)\n"
+         << "  --interest=M            eager or lazy savings interest at maintenance (default eager)\n"
+         << "  --seed=N                trace seed (default 1)\n"
+         << "  --save-trace=PATH       write the generated trace to PATH\n"
+         << "  --trace=PATH            replay the trace at PATH instead of generating one\n"
+         << "  --export-statements=DIR after the run, write every customer's statement to DIR\n"
+         << "  --shards=N              with --export-statements, write N files instead of one per customer\n"
+         << "  --export=DIR            after the run, write transactions, logs and accounts to DIR\n"
+         << "  --export-format=F       csv or jsonl (default csv)\n"
+         << "  --durable=M             none, commit (WAIT_FOR_COMMIT) or background write-ahead logging (default none)\n"
+         << "  --wal=PATH              write-ahead log for --durable (default loadtest.wal in the temp directory, removed after the run)\n";
+}
+
+int main(int argc, char *argv[])
+{
+    size_t accountCount = 100000;
+    size_t opCount = 1000000;
+    LoadDriver::Options options;
+    WorkloadConfig config;
+    string saveTracePath, tracePath;
+    StatementExporter::Options exportOptions;
+    exportOptions.directory.clear();
+    string bulkDirectory;
+    BulkExporter::Format bulkFormat = BulkExporter::Format::CSV;
+    Bank::InterestMode interestMode = Bank::InterestMode::EAGER;
+    string durability = "none";
+    string walPath;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            string arg = argv[i];
+            size_t eq = arg.find('=');
+            string name = arg.substr(0, eq);
+            string value = (eq == string::npos) ? string() : arg.substr(eq + 1);
+            if (name == "--accounts")
+            {
+                accountCount = stoull(value);
+            }
+            else if (name == "--ops")
+            {
+                opCount = stoull(value);
+            }
+            else if (name == "--threads")
+            {
+                options.threadCount = static_cast<unsigned>(stoul(value));
+            }
+            else if (name == "--rate")
+            {
+                options.targetRate = stod(value);
+            }
+            else if (name == "--zipf")
+            {
+                config.zipfExponent = stod(value);
+            }
+            else if (name == "--mix")
+            {
+                unsigned *weights[4] = {&config.depositWeight, &config.withdrawalWeight, &config.transferWeight, &config.overdraftWeight};
+                size_t start = 0;
+                for (unsigned *weight : weights)
+                {
+                    size_t end = value.find(',', start);
+                    *weight = static_cast<unsigned>(stoul(value.substr(start, end - start)));
+                    start = (end == string::npos) ? value.size() : end + 1;
+                }
+            }
+            else if (name == "--maintenance-every")
+            {
+                config.maintenanceInterval = stoull(value);
+            }
+            else if (name == "--interest")
+            {
+                if (value != "eager" && value != "lazy")
+                {
+                    throw invalid_argument(value);
+                }
+                interestMode = (value == "eager") ? Bank::InterestMode::EAGER : Bank::InterestMode::LAZY;
+            }
+            else if (name == "--seed")
+            {
+                config.seed = stoull(value);
+            }
+            else if (name == "--save-trace")
+            {
+                saveTracePath = value;
+            }
+            else if (name == "--trace")
+            {
+                tracePath = value;
+            }
+            else if (name == "--export-statements")
+            {
+                exportOptions.directory = value;
+            }
+            else if (name == "--shards")
+            {
+                exportOptions.shardCount = stoull(value);
+            }
+            else if (name == "--export")
+            {
+                bulkDirectory = value;
+            }
+            else if (name == "--export-format")
+            {
+                if (value != "csv" && value != "jsonl")
+                {
+                    throw invalid_argument(value);
+                }
+                bulkFormat = (value == "csv") ? BulkExporter::Format::CSV : BulkExporter::Format::JSONL;
+            }
+            else if (name == "--durable")
+            {
+                if (value != "none" && value != "commit" && value != "background")
+                {
+                    throw invalid_argument(value);
+                }
+                durability = value;
+            }
+            else if (name == "--wal")
+            {
+                walPath = value;
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return 2;
+            }
+        }
+    }
+    catch (const exception &)
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (accountCount < 2)
+    {
+        cerr << "--accounts must be at least 2\n";
+        return 2;
+    }
+
+    DataManager &dataManager = DataManager::getInstance();
+    dataManager.setSink(DataManager::LogSink::NONE); // Keep stdout pure JSON
+    dataManager.setMinLevel(DataLogEntry::LogLevel::ERROR);
+
+    Bank bank("Load Test Bank");
+    bank.setThreadSafe(options.threadCount > 1);
+    bank.setInterestMode(interestMode);
+    const bool keepWal = !walPath.empty();
+    if (durability != "none")
+    {
+        // Setup is logged in the background so it does not wait on a sync
+        // per account; the run then reopens the same log in the chosen mode
+        if (!keepWal)
+        {
+            walPath = (filesystem::temp_directory_path() / "loadtest.wal").string();
+        }
+        remove(walPath.c_str());
+        bank.enableDurability(walPath, WriteAheadLog::SyncMode::BACKGROUND);
+    }
+    config.savingsCount = accountCount / 2;
+    config.checkingCount = accountCount - config.savingsCount;
+    vector<string> accountNumbers(accountCount); // Savings first, then checking, as WorkloadConfig expects
+    for (size_t i = 0; i < config.checkingCount; ++i)
+    {
+        const Customer &customer = bank.createCustomer("Customer " + to_string(i), "1 Load St", "555-0000");
+        if (i < config.savingsCount)
+        {
+            accountNumbers[i] = bank.createSavingsAccount(customer.getCustomerId(), Money::fromMinorUnits(500000),
+                                                          InterestRate::fromDouble(0.001)).getAccountNumber();
+        }
+        accountNumbers[config.savingsCount + i] = bank.createCheckingAccount(customer.getCustomerId(), Money::fromMinorUnits(100000),
+                                                                             Money::fromMinorUnits(50000)).getAccountNumber();
+    }
+
+    vector<WorkloadOp> trace;
+    try
+    {
+        if (!tracePath.empty())
+        {
+            trace = WorkloadGenerator::loadTrace(tracePath);
+            for (const WorkloadOp &op : trace)
+            {
+                if (op.account >= accountCount || op.otherAccount >= accountCount)
+                {
+                    cerr << "Trace refers to account " << max(op.account, op.otherAccount) << " but the bank has "
+                         << accountCount << "; pass the --accounts it was generated with\n";
+                    return 2;
+                }
+            }
+        }
+        else
+        {
+            trace = WorkloadGenerator(config).generate(opCount);
+        }
+        if (!saveTracePath.empty())
+        {
+            WorkloadGenerator::saveTrace(saveTracePath, trace);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+
+    uint64_t walCommits = 0;
+    if (durability != "none")
+    {
+        bank.enableDurability(walPath, durability == "commit" ? WriteAheadLog::SyncMode::WAIT_FOR_COMMIT
+                                                              : WriteAheadLog::SyncMode::BACKGROUND);
+    }
+    LoadDriver::Result result = LoadDriver(bank, accountNumbers).run(trace, options);
+    if (durability != "none")
+    {
+        walCommits = bank.getWriteAheadLog()->getCommitCount();
+        bank.disableDurability();
+        if (!keepWal)
+        {
+            remove(walPath.c_str());
+        }
+    }
+
+    // Order-sensitive digest of every balance, to compare deterministic replays
+    // (reading a balance settles lazy interest, so both modes give the same)
+    uint64_t checksum = 1469598103934665603ull;
+    for (const string &number : accountNumbers)
+    {
+        checksum = (checksum ^ static_cast<uint64_t>(bank.getAccount(number)->getBalance().getMinorUnits())) * 1099511628211ull;
+    }
+
+    printf("{\n  \"accounts\": %zu,\n  \"operations\": %zu,\n  \"threads\": %u,\n  \"target_rate\": %.0f,\n"
+           "  \"durability\": \"%s\",\n  \"wal_commits\": %llu,\n"
+           "  \"elapsed_seconds\": %.3f,\n  \"ops_per_second\": %.0f,\n  \"balance_checksum\": \"%016llx\",\n  \"latency\": [\n",
+           accountCount, result.operationCount, max(1u, options.threadCount), options.targetRate, durability.c_str(),
+           static_cast<unsigned long long>(walCommits), result.elapsedSeconds,
+           result.operationCount / result.elapsedSeconds, static_cast<unsigned long long>(checksum));
+    bool first = true;
+    for (size_t k = 0; k < WorkloadOp::TYPE_COUNT; ++k)
+    {
+        const LatencyHistogram &h = result.latency[k];
+        if (h.getCount() == 0)
+        {
+            continue;
+        }
+        printf("%s    {\"operation\": \"%s\", \"count\": %llu, \"failed\": %zu, \"mean_ns\": %.0f, \"p50_ns\": %llu, "
+               "\"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu}",
+               first ? "" : ",\n", WorkloadOp::getTypeName(static_cast<WorkloadOp::Type>(k)),
+               static_cast<unsigned long long>(h.getCount()), result.failed[k], h.getMean(),
+               static_cast<unsigned long long>(h.getValueAtPercentile(50)),
+               static_cast<unsigned long long>(h.getValueAtPercentile(99)),
+               static_cast<unsigned long long>(h.getValueAtPercentile(99.9)),
+               static_cast<unsigned long long>(h.getMax()));
+        first = false;
+    }
+    printf("\n  ]");
+
+    if (!exportOptions.directory.empty())
+    {
+        exportOptions.workerCount = max(1u, options.threadCount);
+        exportOptions.onProgress = [](const StatementExporter::Progress &progress)
+        {
+            cerr << "statements: " << progress.customersDone << "/" << progress.customerCount << " customers, "
+                 << progress.bytesWritten / (1024 * 1024) << " MiB\n";
+        };
+        try
+        {
+            StatementExporter::Result exported = StatementExporter(bank).run(exportOptions);
+            printf(",\n  \"statements\": {\"customers\": %zu, \"accounts\": %zu, \"transactions\": %llu, \"files\": %zu, "
+                   "\"bytes\": %llu, \"workers\": %u, \"elapsed_seconds\": %.3f, \"mib_per_second\": %.1f, "
+                   "\"customers_per_second\": %.0f}",
+                   exported.customerCount, exported.accountCount,
+                   static_cast<unsigned long long>(exported.transactionCount), exported.fileCount,
+                   static_cast<unsigned long long>(exported.bytesWritten), exported.workerCount, exported.elapsedSeconds,
+                   exported.getBytesPerSecond() / (1024 * 1024), exported.getCustomersPerSecond());
+        }
+        catch (const exception &e)
+        {
+            printf("\n}\n");
+            cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    if (!bulkDirectory.empty())
+    {
+        const string extension = (bulkFormat == BulkExporter::Format::CSV) ? ".csv" : ".jsonl";
+        try
+        {
+            filesystem::create_directories(bulkDirectory);
+            BulkExporter exporter(bulkFormat);
+            BulkExporter::Result results[3] = {
+                exporter.exportTransactions(bulkDirectory + "/transactions" + extension),
+                exporter.exportLogs(bulkDirectory + "/logs" + extension, dataManager.getLogs()),
+                exporter.exportAccounts(bulkDirectory + "/accounts" + extension, bank)};
+            const char *names[3] = {"transactions", "logs", "accounts"};
+            printf(",\n  \"export\": [\n");
+            for (size_t k = 0; k < 3; ++k)
+            {
+                printf("%s    {\"table\": \"%s\", \"rows\": %zu, \"bytes\": %llu, \"elapsed_seconds\": %.3f, "
+                       "\"mib_per_second\": %.1f}",
+                       k == 0 ? "" : ",\n", names[k], results[k].rowCount,
+                       static_cast<unsigned long long>(results[k].bytesWritten), results[k].elapsedSeconds,
+                       results[k].getBytesPerSecond() / (1024 * 1024));
+            }
+            printf("\n  ]");
+        }
+        catch (const exception &e)
+        {
+            printf("\n}\n");
+            cerr << e.what() << "\n";
+            return 1;
+        }
+    }
+    printf("\n}\n");
+    return 0;
+}
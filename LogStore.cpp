@@ -0,0 +1,943 @@
+#include <cstdint>
+#include <cstdio>        // For FILE
+#include <cstring>       // For memcmp
+#include <ctime>         // For time_t
+#include <condition_variable>
+#include <deque>
+#include <filesystem>    // For the spill directory
+#include <functional>    // For hash
+#include <limits>        // For numeric_limits
+#include <memory>        // For shared_ptr
+#include <mutex>
+#include <optional>
+#include <stdexcept>     // For runtime_error
+#include <string>
+#include <thread>        // For the background spiller
+#include <unordered_map> // For the account/customer index
+#include <vector>
+#include <algorithm>     // For lower_bound
+#include <atomic>        // For numbering stores
+#include <cstdlib>       // For atoll
+#include <system_error>  // For error_code
+#ifdef _WIN32
+#include <process.h> // For _getpid
+#else
+#include <cerrno>
+#include <signal.h> // For kill, to tell whether a spill directory's process has exited
+#include <unistd.h> // For getpid
+#endif
+#include "DataLogEntry.cpp"
+using namespace std;
+
+#ifndef LOGSTORE
+#define LOGSTORE
+
+// Filter for DataManager::queryLogs. Unset fields match every entry and
+// both ranges are inclusive.
+struct LogQuery
+{
+    optional<DataLogEntry::LogLevel> level;
+    time_t fromTime = numeric_limits<time_t>::min();
+    time_t toTime = numeric_limits<time_t>::max();
+    long long fromId = numeric_limits<long long>::min();
+    long long toId = numeric_limits<long long>::max();
+    string relatedTo; // Account number or customer ID, matched against the entry's account and related ID
+};
+
+// How much log history DataManager keeps, and where. With memorySegments
+// set, only that many full segments (plus the one being filled) stay in
+// memory; older ones are compressed into files in directory and read back
+// when a query or view needs them. Each store spills into its own
+// subdirectory, so processes can share directory.
+struct LogRetention
+{
+    size_t memorySegments = 0; // 0 = keep everything in memory
+    string directory;          // Required when memorySegments is set
+    time_t maxAgeSeconds = 0;  // Spilled segments whose newest entry is older are deleted; 0 = keep
+    uint64_t maxDiskBytes = 0; // Oldest spilled segments are deleted beyond this total; 0 = no limit
+};
+
+// A run of consecutive log entries with its own indexes. Capacity is
+// reserved up front, so an appended entry never moves.
+struct LogSegment
+{
+    static const size_t LEVEL_COUNT = 3;
+
+    uint64_t firstPosition = 0;
+    vector<DataLogEntry> entries;
+    // Offsets into entries
+    vector<uint32_t> levelIndex[LEVEL_COUNT];
+    unordered_map<string, vector<uint32_t>> relatedIndex; // Account number or customer ID -> offsets
+
+    void indexLast()
+    {
+        const DataLogEntry &entry = entries.back();
+        uint32_t offset = static_cast<uint32_t>(entries.size() - 1);
+        levelIndex[static_cast<size_t>(entry.getLevel())].push_back(offset);
+        if (!entry.getAccountNumber().empty())
+        {
+            relatedIndex[entry.getAccountNumber()].push_back(offset);
+        }
+        if (!entry.getRelatedId().empty() && entry.getRelatedId() != entry.getAccountNumber())
+        {
+            relatedIndex[entry.getRelatedId()].push_back(offset);
+        }
+    }
+};
+
+// The entries matching a query, in log order. Entries of in-memory segments
+// are read in place and the view shares ownership of those segments, so it
+// stays valid after DataManager::clearLogs(). Entries of spilled segments
+// are read back one segment at a time as the view reaches them; a reference
+// into a spilled segment lasts until the view loads another one, and reading
+// a spilled segment that retention or clearLogs() has since deleted throws
+// runtime_error. A view is not meant to be shared between threads.
+class LogView
+{
+public:
+    class const_iterator
+    {
+    public:
+        const_iterator(const LogView *view, size_t index) : view_(view), index_(index) {}
+
+        const DataLogEntry &operator*() const
+        {
+            return (*view_)[index_];
+        }
+
+        const DataLogEntry *operator->() const
+        {
+            return &(*view_)[index_];
+        }
+
+        const_iterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const
+        {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const const_iterator &other) const
+        {
+            return index_ != other.index_;
+        }
+
+    private:
+        const LogView *view_;
+        size_t index_;
+    };
+
+    size_t size() const
+    {
+        return filtered_ ? positions_.size() : static_cast<size_t>(rangeEnd_ - rangeBegin_);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    const DataLogEntry &operator[](size_t i) const
+    {
+        return entryAt(filtered_ ? positions_[i] : rangeBegin_ + i);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(this, size());
+    }
+
+private:
+    friend class LogStore;
+
+    // Either an in-memory segment or the file it was spilled to
+    struct SegmentRef
+    {
+        shared_ptr<const LogSegment> resident;
+        string path;
+    };
+
+    // A spilled segment LogStore::completeQuery still has to search; its
+    // matches go before positions_[insertAt]
+    struct PendingSegment
+    {
+        size_t segment; // Into segments_
+        size_t insertAt;
+    };
+
+    const DataLogEntry &entryAt(uint64_t position) const;
+
+    vector<SegmentRef> segments_;
+    uint64_t firstSegment_ = 0; // Segment number of segments_[0]
+    mutable shared_ptr<const LogSegment> loaded_; // Spilled segment currently read back
+    mutable uint64_t loadedSegment_ = 0;
+    // Matches are either every position in [rangeBegin_, rangeEnd_) or,
+    // when filtered_, the positions listed in positions_
+    bool filtered_ = false;
+    uint64_t rangeBegin_ = 0;
+    uint64_t rangeEnd_ = 0;
+    vector<uint64_t> positions_;
+    vector<PendingSegment> pending_;
+};
+
+// Append-only log entry storage in fixed-size segments. Every segment keeps
+// a small summary in memory (ID and time bounds, level counts and, once
+// spilled, a filter of the accounts it mentions) so queries skip segments
+// that cannot match, and its own level and account indexes for the ones
+// that might. Full segments beyond LogRetention::memorySegments are handed
+// to a background thread that spills them to disk, oldest first; spilled
+// segments are dropped once they exceed the age or size limits.
+// Not synchronized: the owner holds ownerLock around every call, and the
+// spiller takes it only to pick up and publish its work.
+class LogStore
+{
+public:
+    static const size_t SEGMENT_SIZE = 4096;
+
+    explicit LogStore(mutex &ownerLock) : ownerLock_(ownerLock), storeNumber_(nextStoreNumber()) {}
+
+    LogStore(const LogStore &) = delete;
+    LogStore &operator=(const LogStore &) = delete;
+
+    ~LogStore()
+    {
+        {
+            lock_guard<mutex> lock(ownerLock_);
+            stopSpiller_ = true;
+        }
+        spillWanted_.notify_all();
+        spillsDone_.notify_all();
+        if (spiller_.joinable())
+        {
+            spiller_.join();
+        }
+        deleteSpilledFiles();
+        for (const string &directory : spillDirectories_)
+        {
+            error_code ignored;
+            filesystem::remove(directory, ignored); // Only if empty
+        }
+    }
+
+    // Applies to segments already stored as well as future ones. Segments
+    // are spilled to a subdirectory of retention.directory named after this
+    // process and store ("spill-<pid>-<n>"); subdirectories left by
+    // processes that have exited are removed (not on Windows, where they
+    // are left for the user to delete).
+    void setRetention(const LogRetention &retention)
+    {
+        if (retention.memorySegments > 0)
+        {
+            if (retention.directory.empty())
+            {
+                throw invalid_argument("Log retention needs a spill directory");
+            }
+            if (retention.directory != retention_.directory || spillDirectory_.empty())
+            {
+                filesystem::create_directories(retention.directory);
+                removeAbandonedSpillDirectories(retention.directory);
+                spillDirectory_ = (filesystem::path(retention.directory) /
+                                   ("spill-" + to_string(processId()) + "-" + to_string(storeNumber_))).string();
+                if (find(spillDirectories_.begin(), spillDirectories_.end(), spillDirectory_) == spillDirectories_.end())
+                {
+                    // Left over from an earlier process that had the same ID
+                    filesystem::remove_all(spillDirectory_);
+                    spillDirectories_.push_back(spillDirectory_);
+                }
+                filesystem::create_directories(spillDirectory_);
+            }
+            if (!spiller_.joinable())
+            {
+                spiller_ = thread(&LogStore::spillLoop, this);
+            }
+        }
+        retention_ = retention;
+        enforceRetention();
+    }
+
+    template <typename... Args>
+    const DataLogEntry &append(Args &&...args)
+    {
+        if (slots_.empty() || slots_.back().count == SEGMENT_SIZE)
+        {
+            startSegment();
+        }
+        SegmentSlot &slot = slots_.back();
+        LogSegment &segment = *slot.resident;
+        segment.entries.emplace_back(forward<Args>(args)...);
+        segment.indexLast();
+        slot.summarize(segment.entries.back());
+        ++size_;
+        return segment.entries.back();
+    }
+
+    // Entries logged so far, including any already deleted by retention
+    size_t size() const
+    {
+        return static_cast<size_t>(size_);
+    }
+
+    // Entries still available in memory or on disk
+    size_t getRetainedCount() const
+    {
+        return static_cast<size_t>(size_ - firstRetainedPosition());
+    }
+
+    size_t getResidentSegmentCount() const
+    {
+        return residentCount_;
+    }
+
+    uint64_t getSpilledBytes() const
+    {
+        return spilledBytes_;
+    }
+
+    // Segments whose spill file could not be written; they stay in memory
+    // and are not retried
+    size_t getFailedSpillCount() const
+    {
+        return failedSpills_;
+    }
+
+    // Blocks until the spiller has finished every segment handed to it;
+    // ownerLock is held and released while waiting
+    void waitForSpills(unique_lock<mutex> &ownerLock)
+    {
+        spillsDone_.wait(ownerLock, [this]
+                         { return spillingCount_ == 0 || stopSpiller_; });
+    }
+
+    void clear()
+    {
+        deleteSpilledFiles();
+        slots_.clear();
+        firstSlot_ = 0;
+        size_ = 0;
+        residentCount_ = 0;
+        spilledBytes_ = 0;
+        // A spill still being written sees the new epoch and deletes its file
+        spillQueue_.clear();
+        spillingCount_ = 0;
+        ++epoch_;
+        spillsDone_.notify_all();
+    }
+
+    // First half of a query, run under ownerLock: takes the segment list,
+    // skips segments by their summaries and searches the resident ones via
+    // their account or level index. Spilled candidates are left to
+    // completeQuery, which the owner calls after releasing the lock.
+    LogView query(const LogQuery &q) const
+    {
+        LogView view;
+        view.firstSegment_ = firstSlot_;
+        view.segments_.reserve(slots_.size());
+        for (const SegmentSlot &slot : slots_)
+        {
+            view.segments_.push_back(LogView::SegmentRef{slot.resident, slot.path});
+        }
+        const bool unfiltered = !q.level && q.relatedTo.empty() && q.fromTime == numeric_limits<time_t>::min() &&
+                                q.toTime == numeric_limits<time_t>::max() && q.fromId == numeric_limits<long long>::min() &&
+                                q.toId == numeric_limits<long long>::max();
+        if (unfiltered)
+        {
+            view.rangeBegin_ = firstRetainedPosition();
+            view.rangeEnd_ = size_;
+            return view;
+        }
+
+        view.filtered_ = true;
+        const size_t relatedHash = q.relatedTo.empty() ? 0 : hash<string>()(q.relatedTo);
+        for (size_t i = 0; i < slots_.size(); ++i)
+        {
+            const SegmentSlot &slot = slots_[i];
+            if (slot.count == 0 || slot.lastId < q.fromId || slot.firstId > q.toId || slot.maxTime < q.fromTime ||
+                slot.minTime > q.toTime || (q.level && slot.levelCounts[static_cast<size_t>(*q.level)] == 0) ||
+                (!q.relatedTo.empty() && !slot.resident && !slot.mayMention(relatedHash)))
+            {
+                continue;
+            }
+            if (slot.resident)
+            {
+                match(*slot.resident, q, view.positions_);
+            }
+            else
+            {
+                view.pending_.push_back(LogView::PendingSegment{i, view.positions_.size()});
+            }
+        }
+        return view;
+    }
+
+    // Second half of a query, run without the lock: reads back the spilled
+    // segments query() left pending, one at a time, so memory use does not
+    // depend on how much history matches. A segment deleted in between by
+    // retention or clearLogs() has no matches.
+    static void completeQuery(LogView &view, const LogQuery &q)
+    {
+        if (view.pending_.empty())
+        {
+            return;
+        }
+        vector<uint64_t> positions;
+        positions.reserve(view.positions_.size());
+        size_t next = 0;
+        for (const LogView::PendingSegment &pending : view.pending_)
+        {
+            positions.insert(positions.end(), view.positions_.begin() + next, view.positions_.begin() + pending.insertAt);
+            next = pending.insertAt;
+            shared_ptr<const LogSegment> segment = loadSegment(view.segments_[pending.segment].path, false);
+            if (segment)
+            {
+                match(*segment, q, positions);
+                // Likely the first segment the caller reads
+                view.loaded_ = segment;
+                view.loadedSegment_ = view.firstSegment_ + pending.segment;
+            }
+        }
+        positions.insert(positions.end(), view.positions_.begin() + next, view.positions_.end());
+        view.positions_.swap(positions);
+        view.pending_.clear();
+    }
+
+    // Reads a spill file back into a segment, with its indexes rebuilt.
+    // A missing file throws runtime_error, or returns null unless mustExist.
+    static shared_ptr<const LogSegment> loadSegment(const string &path, bool mustExist = true)
+    {
+        vector<uint8_t> buffer;
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            if (!mustExist)
+            {
+                return nullptr;
+            }
+            throw runtime_error("Log segment " + path + " is no longer available");
+        }
+        uint8_t chunk[65536];
+        size_t read = 0;
+        while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        {
+            buffer.insert(buffer.end(), chunk, chunk + read);
+        }
+        fclose(file);
+
+        Reader in{buffer.data(), buffer.data() + buffer.size(), path};
+        if (buffer.size() < sizeof(SPILL_MAGIC) || memcmp(buffer.data(), SPILL_MAGIC, sizeof(SPILL_MAGIC)) != 0)
+        {
+            throw runtime_error(path + " is not a log segment");
+        }
+        in.next += sizeof(SPILL_MAGIC);
+        shared_ptr<LogSegment> segment = make_shared<LogSegment>();
+        segment->firstPosition = in.varint();
+        uint64_t count = in.varint();
+        vector<string> strings(static_cast<size_t>(in.varint()) + 1); // strings[0] is ""
+        for (size_t i = 1; i < strings.size(); ++i)
+        {
+            strings[i] = in.text(static_cast<size_t>(in.varint()));
+        }
+        segment->entries.reserve(static_cast<size_t>(count));
+        long long id = 0;
+        time_t timestamp = 0;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            id += static_cast<long long>(in.varint());
+            timestamp += static_cast<time_t>(in.signedVarint());
+            uint8_t level = in.byte(), kind = in.byte();
+            const string &account = strings.at(static_cast<size_t>(in.varint()));
+            const string &related = strings.at(static_cast<size_t>(in.varint()));
+            const string &note = strings.at(static_cast<size_t>(in.varint()));
+            Money amount = Money::fromMinorUnits(in.signedVarint());
+            Money balance = Money::fromMinorUnits(in.signedVarint());
+            InterestRate rate = InterestRate::fromPartsPerMillion(in.signedVarint());
+            const string &description = strings.at(static_cast<size_t>(in.varint()));
+            if (level >= LogSegment::LEVEL_COUNT)
+            {
+                throw runtime_error("Log segment " + path + " is corrupt");
+            }
+            segment->entries.emplace_back(DataLogEntry::RestoreTag(), id, timestamp,
+                                          static_cast<DataLogEntry::LogLevel>(level),
+                                          static_cast<DataLogEntry::EventKind>(kind),
+                                          account, amount, balance, related, note, rate, description);
+            segment->indexLast();
+        }
+        return segment;
+    }
+
+private:
+    // In-memory summary of a segment, resident or spilled
+    struct SegmentSlot
+    {
+        static const size_t FILTER_BITS_PER_KEY = 10; // About 1% false positives
+        static const size_t FILTER_HASHES = 7;
+
+        shared_ptr<LogSegment> resident; // Null once spilled
+        string path;                     // Spill file, once spilled
+        uint64_t fileBytes = 0;
+        uint32_t count = 0;
+        long long firstId = 0;
+        long long lastId = 0;
+        time_t minTime = numeric_limits<time_t>::max();
+        time_t maxTime = numeric_limits<time_t>::min();
+        uint32_t levelCounts[LogSegment::LEVEL_COUNT] = {};
+        bool spilling = false;    // Handed to the spiller
+        bool spillFailed = false; // Stays resident for good
+        // Bloom filter of the account numbers and customer IDs, built when
+        // the segment is spilled and sized by how many distinct ones it has
+        vector<uint64_t> mentioned;
+
+        void summarize(const DataLogEntry &entry)
+        {
+            if (count++ == 0)
+            {
+                firstId = entry.getEntryId();
+            }
+            lastId = entry.getEntryId();
+            minTime = min(minTime, entry.getTimestamp());
+            maxTime = max(maxTime, entry.getTimestamp());
+            ++levelCounts[static_cast<size_t>(entry.getLevel())];
+        }
+
+        static vector<uint64_t> buildFilter(const LogSegment &segment)
+        {
+            const size_t keys = segment.relatedIndex.size();
+            vector<uint64_t> filter(keys == 0 ? 0 : (keys * FILTER_BITS_PER_KEY + 63) / 64);
+            for (const auto &entry : segment.relatedIndex)
+            {
+                forEachProbe(hash<string>()(entry.first), filter.size() * 64, [&](uint64_t bit)
+                             {
+                    filter[bit / 64] |= uint64_t(1) << (bit % 64);
+                    return true; });
+            }
+            return filter;
+        }
+
+        bool mayMention(size_t h) const
+        {
+            return forEachProbe(h, mentioned.size() * 64, [&](uint64_t bit)
+                                { return ((mentioned[bit / 64] >> (bit % 64)) & 1) != 0; });
+        }
+
+        // Calls probe(bit) for each of the key's bits (double hashing) until
+        // one returns false; returns whether all returned true
+        template <typename F>
+        static bool forEachProbe(size_t h, uint64_t bits, F probe)
+        {
+            if (bits == 0)
+            {
+                return false;
+            }
+            const uint64_t h1 = static_cast<uint64_t>(h);
+            const uint64_t h2 = ((h1 >> 32) | (h1 << 32)) | 1;
+            for (size_t i = 0; i < FILTER_HASHES; ++i)
+            {
+                if (!probe((h1 + i * h2) % bits))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    // Bounds-checked decoder over a spill file
+    struct Reader
+    {
+        const uint8_t *next;
+        const uint8_t *end;
+        const string &path;
+
+        void need(size_t bytes) const
+        {
+            if (static_cast<size_t>(end - next) < bytes)
+            {
+                throw runtime_error("Log segment " + path + " is truncated");
+            }
+        }
+
+        uint8_t byte()
+        {
+            need(1);
+            return *next++;
+        }
+
+        uint64_t varint()
+        {
+            uint64_t value = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t b = byte();
+                value |= static_cast<uint64_t>(b & 0x7f) << shift;
+                if ((b & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            throw runtime_error("Log segment " + path + " is corrupt");
+        }
+
+        int64_t signedVarint()
+        {
+            uint64_t v = varint();
+            return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+        }
+
+        string text(size_t length)
+        {
+            need(length);
+            string result(reinterpret_cast<const char *>(next), length);
+            next += length;
+            return result;
+        }
+    };
+
+    static constexpr char SPILL_MAGIC[8] = {'B', 'A', 'N', 'K', 'L', 'O', 'G', '2'};
+    static constexpr const char *SPILL_EXTENSION = ".banklog";
+
+    mutex &ownerLock_;
+    const uint64_t storeNumber_; // Tells this process's stores apart in spill directory names
+    LogRetention retention_;
+    string spillDirectory_;           // This store's subdirectory of retention_.directory
+    vector<string> spillDirectories_; // Every one it has used, removed on destruction
+    deque<SegmentSlot> slots_;
+    uint64_t firstSlot_ = 0; // Segment number of slots_[0]; earlier ones were deleted
+    uint64_t size_ = 0;
+    size_t residentCount_ = 0;
+    uint64_t spilledBytes_ = 0;
+    uint64_t nextFileNumber_ = 0; // Never reused, so a view never reads a newer file under an old name
+    size_t failedSpills_ = 0;
+
+    // Spiller state, guarded by ownerLock_
+    thread spiller_;
+    condition_variable spillWanted_;
+    condition_variable spillsDone_;
+    deque<uint64_t> spillQueue_; // Segment numbers, oldest first
+    size_t spillingCount_ = 0;   // Slots queued or being written
+    uint64_t epoch_ = 0;         // Bumped by clear(), which forgets queued and running spills
+    bool stopSpiller_ = false;
+
+    uint64_t firstRetainedPosition() const
+    {
+        return firstSlot_ * SEGMENT_SIZE;
+    }
+
+    static uint64_t nextStoreNumber()
+    {
+        static atomic<uint64_t> next{0};
+        return next++;
+    }
+
+    static long long processId()
+    {
+#ifdef _WIN32
+        return _getpid();
+#else
+        return getpid();
+#endif
+    }
+
+    // Deletes the spill-<pid>-<n> subdirectories of directory whose process
+    // no longer exists
+    static void removeAbandonedSpillDirectories(const string &directory)
+    {
+#ifndef _WIN32
+        for (const filesystem::directory_entry &entry : filesystem::directory_iterator(directory))
+        {
+            const string name = entry.path().filename().string();
+            if (!entry.is_directory() || name.compare(0, 6, "spill-") != 0)
+            {
+                continue;
+            }
+            const long long pid = atoll(name.c_str() + 6);
+            if (pid > 0 && pid != processId() && kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH)
+            {
+                error_code ignored;
+                filesystem::remove_all(entry.path(), ignored);
+            }
+        }
+#else
+        (void)directory;
+#endif
+    }
+
+    void startSegment()
+    {
+        SegmentSlot slot;
+        slot.resident = make_shared<LogSegment>();
+        slot.resident->firstPosition = size_;
+        slot.resident->entries.reserve(SEGMENT_SIZE);
+        slots_.push_back(move(slot));
+        ++residentCount_;
+        enforceRetention();
+    }
+
+    // Hands the oldest full resident segments beyond the memory limit to the
+    // spiller, then deletes spilled segments that are too old or over the
+    // disk budget
+    void enforceRetention()
+    {
+        if (retention_.memorySegments == 0)
+        {
+            return;
+        }
+        // The newest segment is still being filled and never spilled
+        for (size_t i = 0; i + 1 < slots_.size(); ++i)
+        {
+            if (residentCount_ - spillingCount_ <= retention_.memorySegments + 1)
+            {
+                break;
+            }
+            SegmentSlot &slot = slots_[i];
+            if (slot.resident && !slot.spilling && !slot.spillFailed)
+            {
+                slot.spilling = true;
+                ++spillingCount_;
+                spillQueue_.push_back(firstSlot_ + i);
+                spillWanted_.notify_one();
+            }
+        }
+        const time_t now = time(nullptr);
+        while (!slots_.empty() && !slots_.front().resident &&
+               ((retention_.maxDiskBytes != 0 && spilledBytes_ > retention_.maxDiskBytes) ||
+                (retention_.maxAgeSeconds != 0 && slots_.front().maxTime < now - retention_.maxAgeSeconds)))
+        {
+            remove(slots_.front().path.c_str());
+            spilledBytes_ -= slots_.front().fileBytes;
+            slots_.pop_front();
+            ++firstSlot_;
+        }
+    }
+
+    // Background thread: writes queued segments out with ownerLock_
+    // released and swaps each file in for its segment afterwards. A queued
+    // slot is resident, so retention never deletes it meanwhile.
+    void spillLoop()
+    {
+        unique_lock<mutex> lock(ownerLock_);
+        while (true)
+        {
+            spillWanted_.wait(lock, [this]
+                              { return stopSpiller_ || !spillQueue_.empty(); });
+            if (stopSpiller_)
+            {
+                return;
+            }
+            const uint64_t number = spillQueue_.front();
+            spillQueue_.pop_front();
+            const shared_ptr<const LogSegment> segment = slots_[static_cast<size_t>(number - firstSlot_)].resident;
+            const uint64_t epoch = epoch_;
+            const string path = (filesystem::path(spillDirectory_) /
+                                 ("segment-" + to_string(nextFileNumber_++) + SPILL_EXTENSION)).string();
+            lock.unlock();
+
+            const uint64_t bytes = writeSpillFile(*segment, path);
+            vector<uint64_t> filter = bytes != 0 ? SegmentSlot::buildFilter(*segment) : vector<uint64_t>();
+
+            lock.lock();
+            if (epoch != epoch_)
+            {
+                remove(path.c_str());
+                continue;
+            }
+            SegmentSlot &slot = slots_[static_cast<size_t>(number - firstSlot_)];
+            slot.spilling = false;
+            --spillingCount_;
+            if (bytes == 0)
+            {
+                // Keep the segment in memory rather than lose it
+                slot.spillFailed = true;
+                ++failedSpills_;
+            }
+            else
+            {
+                slot.path = path;
+                slot.fileBytes = bytes;
+                slot.mentioned.swap(filter);
+                slot.resident.reset();
+                spilledBytes_ += bytes;
+                --residentCount_;
+                enforceRetention();
+            }
+            spillsDone_.notify_all();
+        }
+    }
+
+    // Appends the entries of segment that match q to positions, in order
+    static void match(const LogSegment &segment, const LogQuery &q, vector<uint64_t> &positions)
+    {
+        const vector<DataLogEntry> &entries = segment.entries;
+        const bool checkTime = q.fromTime != numeric_limits<time_t>::min() || q.toTime != numeric_limits<time_t>::max();
+        // Entry IDs increase with position, so the ID bounds are offsets
+        uint32_t lo = static_cast<uint32_t>(lower_bound(entries.begin(), entries.end(), q.fromId, [](const DataLogEntry &e, long long id)
+                                                        { return e.getEntryId() < id; }) -
+                                            entries.begin());
+        uint32_t hi = static_cast<uint32_t>(entries.size());
+        if (q.toId != numeric_limits<long long>::max())
+        {
+            hi = static_cast<uint32_t>(lower_bound(entries.begin(), entries.end(), q.toId + 1, [](const DataLogEntry &e, long long id)
+                                                   { return e.getEntryId() < id; }) -
+                                       entries.begin());
+        }
+        auto consider = [&](uint32_t offset, bool checkLevel)
+        {
+            const DataLogEntry &entry = entries[offset];
+            if ((!checkLevel || entry.getLevel() == *q.level) &&
+                (!checkTime || (entry.getTimestamp() >= q.fromTime && entry.getTimestamp() <= q.toTime)))
+            {
+                positions.push_back(segment.firstPosition + offset);
+            }
+        };
+        const vector<uint32_t> *candidates = nullptr;
+        bool checkLevel = q.level.has_value();
+        if (!q.relatedTo.empty())
+        {
+            auto it = segment.relatedIndex.find(q.relatedTo);
+            if (it == segment.relatedIndex.end())
+            {
+                return;
+            }
+            candidates = &it->second;
+        }
+        else if (q.level)
+        {
+            candidates = &segment.levelIndex[static_cast<size_t>(*q.level)];
+            checkLevel = false;
+        }
+        if (candidates != nullptr)
+        {
+            for (auto it = lower_bound(candidates->begin(), candidates->end(), lo); it != candidates->end() && *it < hi; ++it)
+            {
+                consider(*it, checkLevel);
+            }
+        }
+        else
+        {
+            for (uint32_t offset = lo; offset < hi; ++offset)
+            {
+                consider(offset, checkLevel);
+            }
+        }
+    }
+
+    // File layout: magic, then varints: first position, entry count, string
+    // count and the strings (length + bytes; index 0 is the empty string).
+    // Each entry is its ID and timestamp as deltas from the previous entry,
+    // level and kind bytes, string indexes for account, related ID and note,
+    // zigzag amount, balance and interest rate (ppm), and a string index
+    // for the description of MESSAGE entries (others are rendered from their
+    // fields again).
+    // Returns the file size, or 0 if it could not be written.
+    static uint64_t writeSpillFile(const LogSegment &segment, const string &path)
+    {
+        vector<uint8_t> body;
+        vector<string> strings;
+        unordered_map<string, uint64_t> stringIndex;
+        auto intern = [&](const string &s) -> uint64_t
+        {
+            if (s.empty())
+            {
+                return 0;
+            }
+            auto inserted = stringIndex.emplace(s, strings.size() + 1);
+            if (inserted.second)
+            {
+                strings.push_back(s);
+            }
+            return inserted.first->second;
+        };
+        long long previousId = 0;
+        time_t previousTime = 0;
+        for (const DataLogEntry &entry : segment.entries)
+        {
+            putVarint(body, static_cast<uint64_t>(entry.getEntryId() - previousId));
+            putSignedVarint(body, static_cast<int64_t>(entry.getTimestamp() - previousTime));
+            previousId = entry.getEntryId();
+            previousTime = entry.getTimestamp();
+            body.push_back(static_cast<uint8_t>(entry.getLevel()));
+            body.push_back(static_cast<uint8_t>(entry.getKind()));
+            putVarint(body, intern(entry.getAccountNumber()));
+            putVarint(body, intern(entry.getRelatedId()));
+            putVarint(body, intern(entry.getNote()));
+            putSignedVarint(body, entry.getAmount().getMinorUnits());
+            putSignedVarint(body, entry.getBalance().getMinorUnits());
+            putSignedVarint(body, entry.getInterestRate().getPartsPerMillion());
+            putVarint(body, entry.getKind() == DataLogEntry::EventKind::MESSAGE ? intern(entry.getDescription()) : 0);
+        }
+        vector<uint8_t> header(SPILL_MAGIC, SPILL_MAGIC + sizeof(SPILL_MAGIC));
+        putVarint(header, segment.firstPosition);
+        putVarint(header, segment.entries.size());
+        putVarint(header, strings.size());
+        for (const string &s : strings)
+        {
+            putVarint(header, s.size());
+            header.insert(header.end(), s.begin(), s.end());
+        }
+
+        FILE *file = fopen(path.c_str(), "wb");
+        bool ok = file != nullptr && fwrite(header.data(), 1, header.size(), file) == header.size() &&
+                  fwrite(body.data(), 1, body.size(), file) == body.size();
+        ok = (file != nullptr && fclose(file) == 0) && ok;
+        if (!ok)
+        {
+            remove(path.c_str());
+            return 0;
+        }
+        return header.size() + body.size();
+    }
+
+    void deleteSpilledFiles()
+    {
+        for (const SegmentSlot &slot : slots_)
+        {
+            if (!slot.resident && !slot.path.empty())
+            {
+                remove(slot.path.c_str());
+            }
+        }
+    }
+
+    static void putVarint(vector<uint8_t> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static void putSignedVarint(vector<uint8_t> &out, int64_t value)
+    {
+        putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+};
+
+constexpr char LogStore::SPILL_MAGIC[8];
+
+inline const DataLogEntry &LogView::entryAt(uint64_t position) const
+{
+    const uint64_t segmentNumber = position / LogStore::SEGMENT_SIZE;
+    const SegmentRef &ref = segments_[segmentNumber - firstSegment_];
+    const LogSegment *segment = ref.resident.get();
+    if (segment == nullptr)
+    {
+        if (!loaded_ || loadedSegment_ != segmentNumber)
+        {
+            loaded_ = LogStore::loadSegment(ref.path);
+            loadedSegment_ = segmentNumber;
+        }
+        segment = loaded_.get();
+    }
+    return segment->entries[position - segment->firstPosition];
+}
+
+#endif // LOGSTORE
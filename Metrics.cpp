@@ -0,0 +1,275 @@
+#include <cstdint>
+#include <cstdio>  // For snprintf
+#include <atomic>
+#include <chrono>
+#include <memory>  // For unique_ptr
+#include <mutex>
+#include <ostream> // For ostream
+#include <vector>
+#include "LatencyHistogram.cpp"
+using namespace std;
+
+#ifndef METRICS
+#define METRICS
+
+// Low-overhead operation metrics: counters and histograms recorded on the
+// hot paths and merged on demand into a Snapshot. Each thread records into
+// its own shard with plain relaxed stores, so recording is a few
+// nanoseconds with no shared cache lines or locks; snapshot() sums the
+// shards. Disabled (the default), recording is a single relaxed load.
+// DataManager::setMetricsEnabled / getMetrics are the usual entry points.
+class Metrics
+{
+public:
+    enum class Counter : uint8_t
+    {
+        DEPOSITS,
+        DEPOSITS_REJECTED,
+        WITHDRAWALS,
+        WITHDRAWALS_REJECTED,
+        OVERDRAFTS_INCURRED,      // Checking withdrawals that left a negative balance
+        OVERDRAFT_LIMIT_EXCEEDED, // Checking withdrawals refused by the overdraft limit
+        TRANSFERS,
+        TRANSFERS_INVALID_AMOUNT,
+        TRANSFERS_SOURCE_NOT_FOUND,
+        TRANSFERS_DESTINATION_NOT_FOUND,
+        TRANSFERS_INSUFFICIENT_FUNDS,
+        MAINTENANCE_RUNS
+    };
+    static const size_t COUNTER_COUNT = 12;
+
+    enum class Histogram : uint8_t
+    {
+        DEPOSIT_NS,
+        WITHDRAWAL_NS,
+        TRANSFER_NS, // transferFunds calls, successful or not
+        MAINTENANCE_NS,
+        LOG_QUEUE_DEPTH // Async log queue length after each enqueue
+    };
+    static const size_t HISTOGRAM_COUNT = 5;
+
+    static const char *getCounterName(Counter counter)
+    {
+        static const char *const names[COUNTER_COUNT] = {
+            "deposits", "deposits_rejected", "withdrawals", "withdrawals_rejected", "overdrafts_incurred",
+            "overdraft_limit_exceeded", "transfers", "transfers_invalid_amount", "transfers_source_not_found",
+            "transfers_destination_not_found", "transfers_insufficient_funds", "maintenance_runs"};
+        return names[static_cast<size_t>(counter)];
+    }
+
+    static const char *getHistogramName(Histogram histogram)
+    {
+        static const char *const names[HISTOGRAM_COUNT] = {
+            "deposit_ns", "withdrawal_ns", "transfer_ns", "maintenance_ns", "log_queue_depth"};
+        return names[static_cast<size_t>(histogram)];
+    }
+
+    // Merged totals across all threads at the time of snapshot()
+    struct Snapshot
+    {
+        uint64_t counters[COUNTER_COUNT] = {};
+        LatencyHistogram histograms[HISTOGRAM_COUNT];
+
+        uint64_t getCounter(Counter counter) const
+        {
+            return counters[static_cast<size_t>(counter)];
+        }
+
+        const LatencyHistogram &getHistogram(Histogram histogram) const
+        {
+            return histograms[static_cast<size_t>(histogram)];
+        }
+
+        // One "name value" line per counter, then one line per non-empty
+        // histogram with its count, mean and percentiles
+        friend ostream &operator<<(ostream &os, const Snapshot &snapshot)
+        {
+            for (size_t i = 0; i < COUNTER_COUNT; ++i)
+            {
+                os << getCounterName(static_cast<Counter>(i)) << ' ' << snapshot.counters[i] << '\n';
+            }
+            for (size_t i = 0; i < HISTOGRAM_COUNT; ++i)
+            {
+                const LatencyHistogram &h = snapshot.histograms[i];
+                if (h.getCount() == 0)
+                {
+                    continue;
+                }
+                char line[256];
+                snprintf(line, sizeof(line), "%s count=%llu min=%llu mean=%.0f p50=%llu p90=%llu p99=%llu p999=%llu max=%llu\n",
+                         getHistogramName(static_cast<Histogram>(i)), static_cast<unsigned long long>(h.getCount()),
+                         static_cast<unsigned long long>(h.getMin()), h.getMean(),
+                         static_cast<unsigned long long>(h.getValueAtPercentile(50)),
+                         static_cast<unsigned long long>(h.getValueAtPercentile(90)),
+                         static_cast<unsigned long long>(h.getValueAtPercentile(99)),
+                         static_cast<unsigned long long>(h.getValueAtPercentile(99.9)),
+                         static_cast<unsigned long long>(h.getMax()));
+                os << line;
+            }
+            return os;
+        }
+    };
+
+    // Times a scope into a histogram; reads the clock only when enabled
+    class Timer
+    {
+    public:
+        explicit Timer(Histogram histogram)
+            : histogram_(histogram), running_(Metrics::getInstance().isEnabled())
+        {
+            if (running_)
+            {
+                start_ = chrono::steady_clock::now();
+            }
+        }
+
+        ~Timer()
+        {
+            if (running_)
+            {
+                Metrics::getInstance().record(histogram_, static_cast<uint64_t>(
+                    chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start_).count()));
+            }
+        }
+
+        Timer(const Timer &) = delete;
+        Timer &operator=(const Timer &) = delete;
+
+    private:
+        Histogram histogram_;
+        bool running_;
+        chrono::steady_clock::time_point start_;
+    };
+
+    static Metrics &getInstance()
+    {
+        static Metrics instance;
+        return instance;
+    }
+
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    void setEnabled(bool enabled)
+    {
+        enabled_.store(enabled, memory_order_relaxed);
+    }
+
+    bool isEnabled() const
+    {
+        return enabled_.load(memory_order_relaxed);
+    }
+
+    void increment(Counter counter, uint64_t amount = 1)
+    {
+        if (isEnabled())
+        {
+            atomic<uint64_t> &value = localShard().counters[static_cast<size_t>(counter)];
+            value.store(value.load(memory_order_relaxed) + amount, memory_order_relaxed);
+        }
+    }
+
+    void record(Histogram histogram, uint64_t value)
+    {
+        if (isEnabled())
+        {
+            localShard().histograms[static_cast<size_t>(histogram)].record(value);
+        }
+    }
+
+    Snapshot snapshot() const
+    {
+        Snapshot result;
+        lock_guard<mutex> lock(shardsMutex_);
+        for (const unique_ptr<Shard> &shard : shards_)
+        {
+            for (size_t i = 0; i < COUNTER_COUNT; ++i)
+            {
+                result.counters[i] += shard->counters[i].load(memory_order_relaxed);
+            }
+            for (size_t i = 0; i < HISTOGRAM_COUNT; ++i)
+            {
+                shard->histograms[i].addTo(result.histograms[i]);
+            }
+        }
+        return result;
+    }
+
+    // Zeroes every shard. Values recorded concurrently may survive or be lost.
+    void reset()
+    {
+        lock_guard<mutex> lock(shardsMutex_);
+        for (const unique_ptr<Shard> &shard : shards_)
+        {
+            for (atomic<uint64_t> &counter : shard->counters)
+            {
+                counter.store(0, memory_order_relaxed);
+            }
+            for (AtomicLatencyHistogram &histogram : shard->histograms)
+            {
+                histogram.reset();
+            }
+        }
+    }
+
+private:
+    // One thread's metrics; written only by the thread that leases it.
+    // Aligned so neighbouring shards never share a cache line.
+    struct alignas(64) Shard
+    {
+        atomic<uint64_t> counters[COUNTER_COUNT] = {};
+        AtomicLatencyHistogram histograms[HISTOGRAM_COUNT];
+        bool leased = false; // Guarded by shardsMutex_
+    };
+
+    // Holds a thread's shard for the thread's lifetime. A shard released by
+    // an exited thread keeps its values and is handed to the next new thread,
+    // so memory is bounded by the peak number of recording threads.
+    struct ShardLease
+    {
+        Shard *shard;
+
+        explicit ShardLease(Metrics &metrics) : shard(metrics.acquireShard()) {}
+
+        ~ShardLease()
+        {
+            Metrics::getInstance().releaseShard(shard);
+        }
+    };
+
+    Metrics() {}
+
+    Shard &localShard()
+    {
+        thread_local ShardLease lease(*this);
+        return *lease.shard;
+    }
+
+    Shard *acquireShard()
+    {
+        lock_guard<mutex> lock(shardsMutex_);
+        for (const unique_ptr<Shard> &shard : shards_)
+        {
+            if (!shard->leased)
+            {
+                shard->leased = true;
+                return shard.get();
+            }
+        }
+        shards_.push_back(unique_ptr<Shard>(new Shard()));
+        shards_.back()->leased = true;
+        return shards_.back().get();
+    }
+
+    void releaseShard(Shard *shard)
+    {
+        lock_guard<mutex> lock(shardsMutex_);
+        shard->leased = false;
+    }
+
+    atomic<bool> enabled_{false};
+    mutable mutex shardsMutex_;
+    vector<unique_ptr<Shard>> shards_;
+};
+
+#endif // METRICS
@@ -0,0 +1,341 @@
+#include <cstdint> // For int64_t
+#include <cstddef> // For size_t
+#include <cmath>   // For llround
+#include <charconv> // For to_chars
+#include <cstring> // For memcpy
+#include <string>
+#include <string_view>
+#include <ostream> // For ostream
+using namespace std;
+
+#ifndef MONEY
+#define MONEY
+
+// Rounding applied when a calculation lands between two minor units
+enum class RoundingMode
+{
+    HALF_EVEN, // Ties go to the even minor unit (banker's rounding)
+    HALF_UP,   // Ties go away from zero
+    DOWN       // Truncate toward zero
+};
+
+// Interest rate held as an integer number of parts per million (0.015 ->
+// 15000), so applying it to a Money amount is exact up to the final rounding.
+class InterestRate
+{
+public:
+    static constexpr int64_t PARTS_PER_UNIT = 1000000;
+
+    constexpr InterestRate() : partsPerMillion_(0) {}
+
+    static constexpr InterestRate fromPartsPerMillion(int64_t partsPerMillion)
+    {
+        return InterestRate(partsPerMillion);
+    }
+
+    static InterestRate fromDouble(double rate)
+    {
+        return InterestRate(llround(rate * PARTS_PER_UNIT));
+    }
+
+    constexpr int64_t getPartsPerMillion() const
+    {
+        return partsPerMillion_;
+    }
+
+    double toDouble() const
+    {
+        return static_cast<double>(partsPerMillion_) / PARTS_PER_UNIT;
+    }
+
+    // Exact decimal fraction without trailing zeros: 1500 ppm -> "0.0015"
+    string toString() const
+    {
+        uint64_t magnitude = partsPerMillion_ < 0 ? 0 - static_cast<uint64_t>(partsPerMillion_) : static_cast<uint64_t>(partsPerMillion_);
+        string text = (partsPerMillion_ < 0 ? "-" : "") + to_string(magnitude / PARTS_PER_UNIT) + ".";
+        string fraction = to_string(PARTS_PER_UNIT + magnitude % PARTS_PER_UNIT).substr(1);
+        size_t last = fraction.find_last_not_of('0');
+        return text + fraction.substr(0, last == string::npos ? 1 : last + 1);
+    }
+
+private:
+    constexpr explicit InterestRate(int64_t partsPerMillion) : partsPerMillion_(partsPerMillion) {}
+
+    int64_t partsPerMillion_;
+};
+
+// Exact monetary amount stored as a whole number of minor units (cents).
+// Addition and subtraction are exact, so sums do not depend on the order
+// or grouping of the terms.
+class Money
+{
+public:
+    static constexpr int64_t MINOR_PER_UNIT = 100;
+
+    constexpr Money() : minorUnits_(0) {}
+
+    static constexpr Money fromMinorUnits(int64_t minorUnits)
+    {
+        return Money(minorUnits);
+    }
+
+    // Converts a decimal amount such as 12.34, rounding to the nearest cent
+    static Money fromDouble(double amount)
+    {
+        return Money(llround(amount * MINOR_PER_UNIT));
+    }
+
+    constexpr int64_t getMinorUnits() const
+    {
+        return minorUnits_;
+    }
+
+    double toDouble() const
+    {
+        return static_cast<double>(minorUnits_) / MINOR_PER_UNIT;
+    }
+
+    // Longest formatTo output: "-92233720368547758.08"
+    static const size_t MAX_TEXT_CHARS = 21;
+
+    // Writes "-1234.56" at out (room for MAX_TEXT_CHARS) and returns the end
+    char *formatTo(char *out) const
+    {
+        uint64_t magnitude = minorUnits_ < 0 ? 0 - static_cast<uint64_t>(minorUnits_) : static_cast<uint64_t>(minorUnits_);
+        if (minorUnits_ < 0)
+        {
+            *out++ = '-';
+        }
+        out = to_chars(out, out + 20, magnitude / MINOR_PER_UNIT).ptr;
+        *out++ = '.';
+        *out++ = static_cast<char>('0' + magnitude % MINOR_PER_UNIT / 10);
+        *out++ = static_cast<char>('0' + magnitude % 10);
+        return out;
+    }
+
+    // Formats as "-1234.56"
+    string toString() const
+    {
+        char text[MAX_TEXT_CHARS];
+        return string(text, formatTo(text));
+    }
+
+    constexpr Money operator+(Money other) const { return Money(minorUnits_ + other.minorUnits_); }
+    constexpr Money operator-(Money other) const { return Money(minorUnits_ - other.minorUnits_); }
+    constexpr Money operator-() const { return Money(-minorUnits_); }
+    Money &operator+=(Money other)
+    {
+        minorUnits_ += other.minorUnits_;
+        return *this;
+    }
+    Money &operator-=(Money other)
+    {
+        minorUnits_ -= other.minorUnits_;
+        return *this;
+    }
+
+    constexpr bool operator==(Money other) const { return minorUnits_ == other.minorUnits_; }
+    constexpr bool operator!=(Money other) const { return minorUnits_ != other.minorUnits_; }
+    constexpr bool operator<(Money other) const { return minorUnits_ < other.minorUnits_; }
+    constexpr bool operator<=(Money other) const { return minorUnits_ <= other.minorUnits_; }
+    constexpr bool operator>(Money other) const { return minorUnits_ > other.minorUnits_; }
+    constexpr bool operator>=(Money other) const { return minorUnits_ >= other.minorUnits_; }
+
+    // amount * rate rounded to a whole minor unit
+    Money applyRate(InterestRate rate, RoundingMode mode = RoundingMode::HALF_EVEN) const;
+
+    // Always two decimals, whatever the stream's precision flags
+    friend ostream &operator<<(ostream &os, Money amount)
+    {
+        char text[MAX_TEXT_CHARS];
+        return os << string_view(text, static_cast<size_t>(amount.formatTo(text) - text));
+    }
+
+private:
+    constexpr explicit Money(int64_t minorUnits) : minorUnits_(minorUnits) {}
+
+    int64_t minorUnits_;
+};
+
+// Ledger::computeInterest uses its blocked kernel only where the target has
+// 256-bit vectors (build with -march=native or -mavx2); on plain x86-64 two
+// lanes do not beat the scalar loop
+#ifndef BANK_VECTOR_INTEREST
+#if defined(__AVX2__)
+#define BANK_VECTOR_INTEREST 1
+#else
+#define BANK_VECTOR_INTEREST 0
+#endif
+#endif
+
+// Bulk kernels over contiguous minor-unit arrays
+class Ledger
+{
+public:
+    // balance * rate in minor units, rounded with HALF_EVEN. Branch-free and
+    // free of floating point so the same inputs give the same cents on any
+    // thread or in any batch. Exact while |balance| / 1e6 * rate fits in int64.
+    static int64_t interestMinorUnits(int64_t balance, int64_t ratePpm)
+    {
+        const int64_t D = InterestRate::PARTS_PER_UNIT;
+        int64_t negative = balance < 0;
+        int64_t magnitude = (balance ^ -negative) + negative;
+        // Split |balance| so the partial products stay in range
+        int64_t whole = (magnitude / D) * ratePpm;
+        int64_t low = (magnitude % D) * ratePpm;
+        int64_t result = whole + low / D;
+        int64_t twiceRemainder = 2 * (low % D);
+        result += (twiceRemainder > D) | ((twiceRemainder == D) & (result & 1));
+        return (result ^ -negative) + negative;
+    }
+
+    // Sum of minor-unit values. Integer addition is associative, so the
+    // compiler may vectorize this loop and callers may split the range across
+    // threads and add the partial sums: the result is bit-identical either way.
+    static int64_t sumMinorUnits(const int64_t *values, size_t count)
+    {
+        int64_t total = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            total += values[i];
+        }
+        return total;
+    }
+
+    // interest[i] = balances[i] * ratesPpm[i] with HALF_EVEN rounding, the
+    // same cents as interestMinorUnits. With 256-bit vectors the work goes
+    // through interestBlock, INTEREST_BLOCK accounts at a time; otherwise
+    // (and for the tail) it is one scalar call per account.
+    static void computeInterest(const int64_t *balances, const int64_t *ratesPpm, int64_t *interest, size_t count)
+    {
+        size_t i = 0;
+        if (BANK_VECTOR_INTEREST)
+        {
+            for (; i + INTEREST_BLOCK <= count; i += INTEREST_BLOCK)
+            {
+                if (!interestBlock(balances + i, ratesPpm + i, interest + i))
+                {
+                    computeInterestScalar(balances + i, ratesPpm + i, interest + i, INTEREST_BLOCK);
+                }
+            }
+        }
+        computeInterestScalar(balances + i, ratesPpm + i, interest + i, count - i);
+    }
+
+    static void computeInterestScalar(const int64_t *balances, const int64_t *ratesPpm, int64_t *interest, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            interest[i] = interestMinorUnits(balances[i], ratesPpm[i]);
+        }
+    }
+
+    static const size_t INTEREST_BLOCK = 16;
+
+    // interestMinorUnits for INTEREST_BLOCK accounts in a loop the compiler
+    // vectorizes: 64-bit division has no vector instruction, so each
+    // division by a million is a multiply by the reciprocal in double
+    // precision followed by one exact correction step, and every branch is a
+    // bit mask. Exact for |balance| < 2^51 and 0 <= rate < 2^20 ppm, where
+    // all intermediates are whole numbers below 2^52; returns false (with
+    // interest unspecified) if any account is outside that range.
+    static bool interestBlock(const int64_t *balances, const int64_t *ratesPpm, int64_t *interest)
+    {
+        const int64_t D = InterestRate::PARTS_PER_UNIT;
+        int64_t in[INTEREST_BLOCK], rates[INTEREST_BLOCK], out[INTEREST_BLOCK];
+        memcpy(in, balances, sizeof(in)); // Local copies: no aliasing checks in the loop
+        memcpy(rates, ratesPpm, sizeof(rates));
+        int64_t outOfRange = 0;
+        for (size_t i = 0; i < INTEREST_BLOCK; ++i)
+        {
+            int64_t negative = in[i] >> 63;
+            int64_t magnitude = (in[i] ^ negative) - negative;
+            outOfRange |= (magnitude >> 51) | (rates[i] >> 20);
+            double remainder = 0, lowRemainder = 0;
+            double whole = divideByMillion(wholeToDouble(magnitude & ((int64_t(1) << 51) - 1)), remainder);
+            double rate = wholeToDouble(rates[i] & ((int64_t(1) << 20) - 1));
+            int64_t result = doubleToWhole(whole * rate + divideByMillion(remainder * rate, lowRemainder));
+            int64_t twiceRemainder = 2 * doubleToWhole(lowRemainder);
+            result += ((D - twiceRemainder - (result & 1)) >> 63) & 1; // Up if 2r > D, or 2r == D and odd
+            out[i] = (result ^ negative) - negative;
+        }
+        memcpy(interest, out, sizeof(out));
+        return outOfRange == 0;
+    }
+
+private:
+    // Whole numbers in [0, 2^52) convert to and from double through the
+    // mantissa of 2^52 + n, which needs only bitwise ops and one add
+    static constexpr double TWO_POW_52 = 4503599627370496.0;
+    static const int64_t TWO_POW_52_BITS = 0x4330000000000000;
+    static const int64_t ONE_BITS = 0x3FF0000000000000; // 1.0
+
+    static int64_t bitsOf(double value)
+    {
+        int64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static double fromBits(int64_t bits)
+    {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static double wholeToDouble(int64_t n)
+    {
+        return fromBits(n | TWO_POW_52_BITS) - TWO_POW_52;
+    }
+
+    static int64_t doubleToWhole(double n)
+    {
+        return bitsOf(n + TWO_POW_52) - TWO_POW_52_BITS;
+    }
+
+    // 1.0 if value is negative, else 0.0
+    static double oneIfNegative(double value)
+    {
+        return fromBits((bitsOf(value) >> 63) & ONE_BITS);
+    }
+
+    // floor(n / 1e6) and n % 1e6 for a whole number 0 <= n < 2^52. The
+    // rounded reciprocal estimate is off by at most one, and n - q * 1e6 is
+    // exact, so one step in either direction corrects it.
+    static double divideByMillion(double n, double &remainder)
+    {
+        const double D = static_cast<double>(InterestRate::PARTS_PER_UNIT);
+        double q = (n * (1 / D) + TWO_POW_52) - TWO_POW_52;
+        double r = n - q * D;
+        double under = oneIfNegative(r);
+        q -= under;
+        r += under * D;
+        double over = oneIfNegative((D - 1) - r);
+        q += over;
+        r -= over * D;
+        remainder = r;
+        return q;
+    }
+};
+
+inline Money Money::applyRate(InterestRate rate, RoundingMode mode) const
+{
+    if (mode == RoundingMode::HALF_EVEN)
+    {
+        return Money::fromMinorUnits(Ledger::interestMinorUnits(minorUnits_, rate.getPartsPerMillion()));
+    }
+    const int64_t D = InterestRate::PARTS_PER_UNIT;
+    int64_t value = minorUnits_;
+    int64_t magnitude = value < 0 ? -value : value;
+    int64_t whole = (magnitude / D) * rate.getPartsPerMillion();
+    int64_t low = (magnitude % D) * rate.getPartsPerMillion();
+    int64_t result = whole + low / D;
+    if (mode == RoundingMode::HALF_UP && 2 * (low % D) >= D)
+    {
+        ++result;
+    }
+    return Money::fromMinorUnits(value < 0 ? -result : result);
+}
+
+#endif // MONEY
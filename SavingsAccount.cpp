@@ -1,40 +1,61 @@
 #include "Account.cpp"
 #include "DataManager.cpp" // For logging
 #include "Transaction.cpp"
+#include "TransactionJournal.cpp" // For backdated interest rows
+#include <vector>
+#include <algorithm> // For max
+#include <limits>
 using namespace std;
 
 #ifndef SAVINGSACCOUNT
 #define SAVINGSACCOUNT
-class SavingsAccount : public Account
+class SavingsAccount final : public Account
 {
 public:
-    SavingsAccount(const string &ownerId, double initialBalance, double interestRate)
+    SavingsAccount(const string &ownerId, Money initialBalance, InterestRate interestRate)
         : Account(ownerId, initialBalance), interestRate_(interestRate)
     {
-        DataManager::getInstance().logEvent(
-            DataLogEntry::LogLevel::INFO,
-            "SavingsAccount created: " + accountNumber_ + " for owner " + ownerId_ + " with interest rate " + to_string(interestRate_));
+        kind_ = Kind::SAVINGS;
+        DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+            DataLogEntry::EventKind::SAVINGS_ACCOUNT_CREATED, accountNumber_, Money(), Money(), ownerId_,
+            string(), interestRate_);
     }
 
-    double getInterestRate() const
+    SavingsAccount(RestoreTag tag, const string &accountNumber, const string &ownerId, Money balance, InterestRate interestRate)
+        : Account(tag, accountNumber, ownerId, balance), interestRate_(interestRate)
+    {
+        kind_ = Kind::SAVINGS;
+    }
+
+    InterestRate getInterestRate() const
     {
         return interestRate_;
     }
 
     void applyInterest()
     { // Applies interest to the account balance
-        double interestAmount = balance_ * interestRate_;
-        if (deposit(interestAmount, "Monthly Interest"))
+        WriteAheadLog *wal = wal_.load();
+        uint64_t lsn = 0;
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::INFO,
-                "Interest of $" + to_string(interestAmount) + " applied to SavingsAccount " + accountNumber_ + ". New balance: $" + to_string(balance_));
+            unique_lock<mutex> guard = lock();
+            // Rounded to the cent with HALF_EVEN, the same as Ledger::computeInterest
+            Money interestAmount = balance_.applyRate(interestRate_);
+            if (!depositUnlocked(interestAmount, "Monthly Interest"))
+            {
+                DataManager::getInstance().logEvent<DataLogEntry::LogLevel::ERROR>(
+                    DataLogEntry::EventKind::INTEREST_FAILED, accountNumber_);
+                return;
+            }
+            DataManager::getInstance().logEvent<DataLogEntry::LogLevel::INFO>(
+                DataLogEntry::EventKind::INTEREST_APPLIED, accountNumber_, interestAmount, balance_);
+            if (wal != nullptr)
+            {
+                lsn = logPosting(*wal, WriteAheadLog::RecordType::DEPOSIT, interestAmount, "Monthly Interest");
+            }
         }
-        else
+        if (wal != nullptr)
         {
-            DataManager::getInstance().logEvent(
-                DataLogEntry::LogLevel::ERROR,
-                "Failed to apply interest to SavingsAccount " + accountNumber_);
+            wal->waitDurable(lsn);
         }
     }
 
@@ -44,8 +65,54 @@ public:
         applyInterest();
     }
 
+protected:
+    // Posts one "Monthly Interest" credit per closed period since the last
+    // settlement, each on the balance left by the one before and stamped
+    // with its period's close time: the same amounts, rows and timestamps
+    // that eager maintenance would have written at the month-end. A posting
+    // that ran while the period was being closed can be stamped after its
+    // end; credits are then stamped with that posting's time instead, so the
+    // account's rows stay in timestamp order. Caller holds lock().
+    void accrueInterestUnlocked() override
+    {
+        TransactionJournal &journal = TransactionJournal::getInstance();
+        WriteAheadLog *wal = wal_.load();
+        const uint64_t target = interestSchedule_->getPeriodCount();
+        vector<int64_t> values(1, static_cast<int64_t>(target)); // WAL record: period, then credits
+        time_t notBefore = numeric_limits<time_t>::min();
+        if (settledPeriod_ < target && !transactionRows_.empty())
+        {
+            int64_t id = 0, timestamp = 0;
+            journal.getStamp(transactionRows_.back(), id, timestamp);
+            notBefore = static_cast<time_t>(timestamp);
+        }
+        for (uint64_t period = settledPeriod_; period < target; ++period)
+        {
+            // Rounded to the cent with HALF_EVEN, the same as Ledger::computeInterest
+            Money interestAmount = balance_.applyRate(interestRate_);
+            if (interestAmount <= Money())
+            {
+                break; // The balance cannot change until the next posting, so no later period pays either
+            }
+            size_t row = journal.appendAt(Transaction::Type::DEPOSIT, interestAmount, journalAccountId_, "Monthly Interest",
+                                          max(interestSchedule_->getPeriodEnd(period), notBefore));
+            postTransaction(Transaction::Type::DEPOSIT, interestAmount, row);
+            if (wal != nullptr)
+            {
+                int64_t id = 0, timestamp = 0;
+                journal.getStamp(row, id, timestamp);
+                values.insert(values.end(), {interestAmount.getMinorUnits(), id, timestamp});
+            }
+        }
+        settledPeriod_ = target;
+        if (wal != nullptr)
+        {
+            wal->append(WriteAheadLog::RecordType::INTEREST_SETTLED, {string_view(accountNumber_)}, values);
+        }
+    }
+
 private:
-    double interestRate_; // e.g., 0.01 for 1%
+    InterestRate interestRate_; // e.g., 10000 ppm for 1%
 };
 
 #endif // SAVINGSACCOUNT
\ No newline at end of file
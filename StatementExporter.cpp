@@ -0,0 +1,358 @@
+#include <cstdint>
+#include <ctime>              // For time_t
+#include <atomic>
+#include <chrono>
+#include <condition_variable> // For the progress loop
+#include <exception>          // For exception_ptr
+#include <filesystem>         // For the output directory
+#include <functional>         // For the progress callback
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Bank.cpp"
+#include "BufferedWriter.cpp"
+using namespace std;
+
+#ifndef STATEMENTEXPORTER
+#define STATEMENTEXPORTER
+
+// Writes account statements for every customer of a Bank: each customer's
+// accounts with opening balance, the transactions in the period and closing
+// balance. Customers are split between worker threads, and each worker
+// renders through its own BufferedWriter, so workers share nothing but a
+// work counter. Output is either one file per customer
+// (statement-<customer ID>.txt) or shardCount files (statements-NNNN.txt)
+// each holding a contiguous run of customers.
+//
+// The directory lock is held shared for the whole export, so accounts
+// cannot be created or closed meanwhile. Postings carry on: each account
+// is locked only while its rows are copied out.
+class StatementExporter
+{
+public:
+    struct Progress
+    {
+        size_t customersDone = 0;
+        size_t customerCount = 0;
+        uint64_t transactionCount = 0; // Transactions written so far
+        uint64_t bytesWritten = 0;
+        double elapsedSeconds = 0.0;
+    };
+
+    struct Options
+    {
+        string directory = "statements";
+        time_t from = numeric_limits<time_t>::min(); // Period is from <= timestamp < to
+        time_t to = numeric_limits<time_t>::max();
+        size_t shardCount = 0;       // 0 = one file per customer
+        unsigned workerCount = 0;    // 0 = hardware concurrency
+        size_t bufferBytes = 1 << 20; // Per worker
+        function<void(const Progress &)> onProgress; // Called from the calling thread
+        chrono::milliseconds progressInterval = chrono::milliseconds(500);
+    };
+
+    struct Result
+    {
+        size_t customerCount = 0;
+        size_t accountCount = 0;
+        uint64_t transactionCount = 0;
+        size_t fileCount = 0;
+        uint64_t bytesWritten = 0;
+        unsigned workerCount = 0;
+        double elapsedSeconds = 0.0;
+
+        double getBytesPerSecond() const
+        {
+            return elapsedSeconds > 0 ? bytesWritten / elapsedSeconds : 0.0;
+        }
+
+        double getCustomersPerSecond() const
+        {
+            return elapsedSeconds > 0 ? customerCount / elapsedSeconds : 0.0;
+        }
+    };
+
+    explicit StatementExporter(const Bank &bank) : bank_(bank) {}
+
+    // Writes every statement and returns the totals. Throws runtime_error if
+    // a file cannot be written; files already written are left in place.
+    Result run(const Options &options)
+    {
+        filesystem::create_directories(options.directory);
+        Result result;
+        bank_.withCustomers([&](CustomerRange customers)
+                            { result = exportAll(customers, options); });
+        return result;
+    }
+
+private:
+    static const size_t CUSTOMER_CHUNK = 64; // Customers claimed at a time in per-customer mode
+
+    // Shared by all workers of one run
+    struct RunState
+    {
+        CustomerRange customers;
+        const Options &options;
+        size_t unitCount; // Files to write: customers or shards
+        atomic<size_t> nextUnit{0};
+        atomic<size_t> customersDone{0};
+        atomic<size_t> accountCount{0};
+        atomic<uint64_t> transactionCount{0};
+        atomic<uint64_t> bytesWritten{0};
+        atomic<bool> failed{false};
+        mutex doneMutex;
+        condition_variable doneChanged;
+        unsigned runningWorkers = 0; // Guarded by doneMutex
+        exception_ptr error;         // First worker failure; guarded by doneMutex
+
+        RunState(CustomerRange customerList, const Options &runOptions, size_t units)
+            : customers(customerList), options(runOptions), unitCount(units) {}
+    };
+
+    // One worker's writer and scratch columns, reused across accounts
+    struct Worker
+    {
+        BufferedWriter writer;
+        vector<int64_t> ids;
+        vector<int64_t> timestamps;
+        vector<uint8_t> types;
+        vector<int64_t> amounts;
+        vector<uint32_t> descriptionIds;
+        uint64_t reportedBytes = 0;
+
+        explicit Worker(size_t bufferBytes) : writer(bufferBytes) {}
+    };
+
+    const Bank &bank_;
+
+    Result exportAll(CustomerRange customers, const Options &options)
+    {
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        const size_t unitCount = (options.shardCount > 0) ? options.shardCount
+                                                          : (customers.size() + CUSTOMER_CHUNK - 1) / CUSTOMER_CHUNK;
+        RunState state(customers, options, unitCount);
+
+        unsigned workerCount = options.workerCount;
+        if (workerCount == 0)
+        {
+            workerCount = max(1u, thread::hardware_concurrency());
+        }
+        workerCount = static_cast<unsigned>(min<size_t>(workerCount, max<size_t>(unitCount, 1)));
+        state.runningWorkers = workerCount;
+        vector<thread> workers;
+        for (unsigned t = 0; t < workerCount; ++t)
+        {
+            workers.emplace_back([this, &state]()
+                                 { runWorker(state); });
+        }
+
+        // Report progress until the workers finish
+        auto elapsed = [&start]()
+        {
+            return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        };
+        {
+            unique_lock<mutex> lock(state.doneMutex);
+            while (state.runningWorkers > 0)
+            {
+                state.doneChanged.wait_for(lock, options.progressInterval);
+                if (options.onProgress && state.runningWorkers > 0)
+                {
+                    lock.unlock();
+                    options.onProgress(makeProgress(state, elapsed()));
+                    lock.lock();
+                }
+            }
+        }
+        for (thread &t : workers)
+        {
+            t.join();
+        }
+        if (state.error)
+        {
+            rethrow_exception(state.error);
+        }
+
+        Result result;
+        result.customerCount = customers.size();
+        result.accountCount = state.accountCount.load();
+        result.transactionCount = state.transactionCount.load();
+        result.fileCount = (options.shardCount > 0) ? options.shardCount : customers.size();
+        result.bytesWritten = state.bytesWritten.load();
+        result.workerCount = workerCount;
+        result.elapsedSeconds = elapsed();
+        if (options.onProgress)
+        {
+            options.onProgress(makeProgress(state, result.elapsedSeconds));
+        }
+        return result;
+    }
+
+    static Progress makeProgress(const RunState &state, double elapsedSeconds)
+    {
+        Progress progress;
+        progress.customersDone = state.customersDone.load(memory_order_relaxed);
+        progress.customerCount = state.customers.size();
+        progress.transactionCount = state.transactionCount.load(memory_order_relaxed);
+        progress.bytesWritten = state.bytesWritten.load(memory_order_relaxed);
+        progress.elapsedSeconds = elapsedSeconds;
+        return progress;
+    }
+
+    void runWorker(RunState &state)
+    {
+        try
+        {
+            Worker worker(state.options.bufferBytes);
+            const size_t customerCount = state.customers.size();
+            for (size_t unit = state.nextUnit.fetch_add(1); unit < state.unitCount && !state.failed.load(memory_order_relaxed);
+                 unit = state.nextUnit.fetch_add(1))
+            {
+                if (state.options.shardCount > 0)
+                {
+                    char name[48];
+                    snprintf(name, sizeof(name), "statements-%04zu.txt", unit);
+                    worker.writer.open((filesystem::path(state.options.directory) / name).string());
+                    size_t first = unit * customerCount / state.unitCount;
+                    size_t last = (unit + 1) * customerCount / state.unitCount;
+                    for (size_t c = first; c < last; ++c)
+                    {
+                        writeStatement(worker, state, state.customers[c]);
+                    }
+                    worker.writer.close();
+                }
+                else
+                {
+                    size_t last = min((unit + 1) * CUSTOMER_CHUNK, customerCount);
+                    for (size_t c = unit * CUSTOMER_CHUNK; c < last; ++c)
+                    {
+                        const Customer &customer = state.customers[c];
+                        worker.writer.open((filesystem::path(state.options.directory) /
+                                            ("statement-" + customer.getCustomerId() + ".txt")).string());
+                        writeStatement(worker, state, customer);
+                        worker.writer.close();
+                    }
+                }
+            }
+        }
+        catch (...)
+        {
+            lock_guard<mutex> lock(state.doneMutex);
+            if (!state.error)
+            {
+                state.error = current_exception();
+            }
+            state.failed.store(true, memory_order_relaxed);
+        }
+        lock_guard<mutex> lock(state.doneMutex);
+        --state.runningWorkers;
+        state.doneChanged.notify_one();
+    }
+
+    void writeStatement(Worker &worker, RunState &state, const Customer &customer)
+    {
+        BufferedWriter &out = worker.writer;
+        out.write("STATEMENT ").write(customer.getCustomerId()).write("  ").write(customer.getName()).put('\n');
+        out.write(customer.getAddress()).put('\n');
+        out.write("Period: ");
+        writeBound(out, state.options.from, "beginning");
+        out.write(" to ");
+        writeBound(out, state.options.to, "now");
+        out.write(" UTC\n");
+
+        uint64_t transactions = 0;
+        const vector<Account *> &accounts = customer.getAccounts();
+        for (Account *account : accounts)
+        {
+            transactions += writeAccount(worker, state.options, *account);
+        }
+        out.put('\n');
+
+        state.accountCount.fetch_add(accounts.size(), memory_order_relaxed);
+        state.transactionCount.fetch_add(transactions, memory_order_relaxed);
+        state.bytesWritten.fetch_add(out.getBytesWritten() - worker.reportedBytes, memory_order_relaxed);
+        worker.reportedBytes = out.getBytesWritten();
+        state.customersDone.fetch_add(1, memory_order_relaxed);
+    }
+
+    // Writes one account's section and returns how many transactions it lists
+    static size_t writeAccount(Worker &worker, const Options &options, Account &account)
+    {
+        const TransactionJournal &journal = TransactionJournal::getInstance();
+        Money balance;
+        size_t periodCount = 0;
+        size_t laterCount = 0;
+        {
+            // Copy the rows from the period start onwards while the account
+            // is locked, so the balance matches them; render after unlocking
+            unique_lock<mutex> guard = account.lock();
+            account.settleInterestUnlocked(); // Lazily accrued interest belongs on the statement
+            balance = account.getBalanceUnlocked();
+            TransactionHistory history = account.getTransactionHistory();
+            const size_t *rows = history.getRows();
+            size_t first = journal.lowerBoundByTime(rows, history.size(), options.from);
+            size_t last = max(first, journal.lowerBoundByTime(rows, history.size(), options.to));
+            periodCount = last - first;
+            laterCount = history.size() - last;
+            size_t count = history.size() - first;
+            worker.ids.resize(count);
+            worker.timestamps.resize(count);
+            worker.types.resize(count);
+            worker.amounts.resize(count);
+            worker.descriptionIds.resize(count);
+            journal.readRows(rows + first, count, worker.ids.data(), worker.timestamps.data(), worker.types.data(),
+                             worker.amounts.data(), worker.descriptionIds.data());
+        }
+
+        // Signed amounts: withdrawals reduce the balance, everything else adds
+        auto signedAmount = [&worker](size_t i)
+        {
+            return (static_cast<Transaction::Type>(worker.types[i]) == Transaction::Type::WITHDRAWAL) ? -worker.amounts[i]
+                                                                                                        : worker.amounts[i];
+        };
+        int64_t closing = balance.getMinorUnits();
+        for (size_t i = periodCount; i < periodCount + laterCount; ++i)
+        {
+            closing -= signedAmount(i);
+        }
+        int64_t opening = closing;
+        for (size_t i = 0; i < periodCount; ++i)
+        {
+            opening -= signedAmount(i);
+        }
+
+        BufferedWriter &out = worker.writer;
+        out.write("Account ").write(account.getAccountNumber()).write(" (").write(Account::getKindName(account.getKind())).write(")\n");
+        out.write("  Opening balance ").writeMoney(Money::fromMinorUnits(opening)).put('\n');
+        for (size_t i = 0; i < periodCount; ++i)
+        {
+            out.write("  ").writeDateTime(static_cast<time_t>(worker.timestamps[i])).write("  #").writeInt(worker.ids[i]);
+            out.put(' ').write(Transaction::getTypeName(static_cast<Transaction::Type>(worker.types[i]))).put(' ');
+            out.writeMoney(Money::fromMinorUnits(signedAmount(i)));
+            const string &description = journal.getDescription(worker.descriptionIds[i]);
+            if (!description.empty())
+            {
+                out.write("  ").write(description);
+            }
+            out.put('\n');
+        }
+        out.write("  Closing balance ").writeMoney(Money::fromMinorUnits(closing)).put('\n');
+        return periodCount;
+    }
+
+    static void writeBound(BufferedWriter &out, time_t bound, const char *unbounded)
+    {
+        if (bound == numeric_limits<time_t>::min() || bound == numeric_limits<time_t>::max())
+        {
+            out.write(unbounded);
+        }
+        else
+        {
+            out.writeDateTime(bound);
+        }
+    }
+};
+
+#endif // STATEMENTEXPORTER
@@ -0,0 +1,94 @@
+#include <cstdint>
+#include <cstddef>  // For size_t
+#include <charconv> // For to_chars
+#include <ctime>    // For time_t
+#include "Money.cpp"
+using namespace std;
+
+#ifndef TEXTFORMAT
+#define TEXTFORMAT
+
+// Formatting primitives that write straight into a caller-provided char
+// buffer and return the end of what they wrote. Each has a fixed worst-case
+// length (the MAX_*_CHARS constants), so callers reserve that much and
+// never allocate. Output does not depend on locale or stream flags.
+class TextFormat
+{
+public:
+    static const size_t MAX_INT_CHARS = 20;      // "-9223372036854775808"
+    static const size_t MAX_MONEY_CHARS = Money::MAX_TEXT_CHARS;
+    static const size_t MAX_DATETIME_CHARS = 32; // Years outside 0..9999 print in full
+
+    static char *appendInt(char *out, int64_t value)
+    {
+        return to_chars(out, out + MAX_INT_CHARS, value).ptr;
+    }
+
+    static char *appendUnsigned(char *out, uint64_t value)
+    {
+        return to_chars(out, out + MAX_INT_CHARS, value).ptr;
+    }
+
+    static char *appendMoney(char *out, Money amount)
+    {
+        return amount.formatTo(out);
+    }
+
+    // UTC "YYYY-MM-DD HH:MM:SS", with separator between date and time
+    // ('T' plus a trailing 'Z' appended by the caller gives ISO 8601).
+    // Computed arithmetically rather than through gmtime, which may lock.
+    static char *appendDateTime(char *out, time_t timestamp, char separator = ' ')
+    {
+        int64_t seconds = static_cast<int64_t>(timestamp);
+        int64_t days = seconds / 86400;
+        int64_t secondOfDay = seconds % 86400;
+        if (secondOfDay < 0)
+        {
+            secondOfDay += 86400;
+            --days;
+        }
+        // Civil date from days since 1970-01-01 (proleptic Gregorian)
+        days += 719468;
+        const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const int64_t dayOfEra = days - era * 146097;
+        const int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+        const int64_t day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        const int64_t month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        const int64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+
+        if (year >= 0 && year <= 9999)
+        {
+            out = appendDigits(out, year, 4);
+        }
+        else
+        {
+            out = appendInt(out, year);
+        }
+        *out++ = '-';
+        out = appendDigits(out, month, 2);
+        *out++ = '-';
+        out = appendDigits(out, day, 2);
+        *out++ = separator;
+        out = appendDigits(out, secondOfDay / 3600, 2);
+        *out++ = ':';
+        out = appendDigits(out, secondOfDay / 60 % 60, 2);
+        *out++ = ':';
+        return appendDigits(out, secondOfDay % 60, 2);
+    }
+
+private:
+    // value (0 <= value < 10^width) zero-padded to width digits
+    static char *appendDigits(char *out, int64_t value, int width)
+    {
+        for (int i = width - 1; i >= 0; --i)
+        {
+            out[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        return out + width;
+    }
+};
+
+#endif // TEXTFORMAT
@@ -1,16 +1,19 @@
-#include <map>    // For mapping enum to string
 #include <chrono> // For timestamp
 #include <ctime>  // For time_t
-#include <map>
+#include <cstddef> // For size_t
 #include <iostream>
-#include <iomanip>
 #include <string>
 #include <ostream> // For ostream
 #include <atomic>  // For unique ID generation
+#include "Money.cpp" // For exact amounts
 using namespace std;
 
 #ifndef TRANSACTION
 #define TRANSACTION
+
+// Read-only view of one row of the TransactionJournal. The account number
+// and description point at the journal's interned strings, so copies are
+// cheap and no string is duplicated per transaction.
 class Transaction
 {
 public:
@@ -20,10 +23,18 @@ public:
         WITHDRAWAL,
         TRANSFER
     };
+    static const size_t TYPE_COUNT = 3;
+
+    static constexpr const char *getTypeName(Type type)
+    {
+        constexpr const char *names[TYPE_COUNT] = {"DEPOSIT", "WITHDRAWAL", "TRANSFER"};
+        return names[static_cast<size_t>(type)];
+    }
 
-    Transaction(Type type, double amount, const string &accountNum, const string &description = "")
-        : transactionId_(nextId++), timestamp_(), type_(type), amount_(amount),
-          accountNumber_(accountNum), description_(description) {}
+    Transaction(long transactionId, time_t timestamp, Type type, Money amount,
+                const string &accountNum, const string &description)
+        : transactionId_(transactionId), timestamp_(timestamp), type_(type), amount_(amount),
+          accountNumber_(&accountNum), description_(&description) {}
 
     long getTransactionId() const
     {
@@ -40,48 +51,44 @@ public:
         return type_;
     }
 
-    double getAmount() const
+    Money getAmount() const
     {
         return amount_;
     }
 
     const string &getAccountNumber() const
     {
-        return accountNumber_;
+        return *accountNumber_;
     }
 
     const string &getDescription() const
     {
-        return description_;
+        return *description_;
     }
 
-    // Overload stream insertion operator for easy printing
+    // Overload stream insertion operator for easy printing; leaves the
+    // stream's formatting flags as they were
     friend ostream &operator<<(ostream &os, const Transaction &transaction)
     {
-        map<Type, string> typeMap = {
-            {Type::DEPOSIT, "DEPOSIT"},
-            {Type::WITHDRAWAL, "WITHDRAWAL"},
-            {Type::TRANSFER, "TRANSFER"}};
-
         os << "[TRXID:" << transaction.getTransactionId() << "] "
            << "[" << transaction.getTimestamp() << "] "
-           << "[" << typeMap[transaction.getType()] << "] "
+           << "[" << getTypeName(transaction.getType()) << "] "
            << "Account: " << transaction.getAccountNumber() << ", "
-           << "Amount: $" << fixed << setprecision(2) << transaction.getAmount() << " "
-           << (transaction.getDescription().empty() ? "" : "(" + transaction.getDescription() + ")");
+           << "Amount: $" << transaction.getAmount() << " ";
+        if (!transaction.getDescription().empty())
+        {
+            os << "(" << transaction.getDescription() << ")";
+        }
         return os;
     }
 
 private:
-    static int nextId;
     long transactionId_;
     time_t timestamp_;
     Type type_;
-    double amount_;
-    string accountNumber_; // Account associated with this transaction
-    string description_;
+    Money amount_;
+    const string *accountNumber_; // Account associated with this transaction
+    const string *description_;
 };
 
-int Transaction::nextId = 1001;
-
-#endif // TRANSACTION
\ No newline at end of file
+#endif // TRANSACTION
@@ -0,0 +1,444 @@
+#include <cstdint> // For fixed-width column types
+#include <ctime>   // For time_t
+#include <deque>   // For stable interned string storage
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>    // For max
+#include <memory>       // For shared_ptr
+#include <mutex>        // For unique_lock
+#include <shared_mutex> // For concurrent readers
+#include "Money.cpp"
+#include "Transaction.cpp"
+using namespace std;
+
+#ifndef TRANSACTIONJOURNAL
+#define TRANSACTIONJOURNAL
+
+// Bank-wide transaction store laid out as structure-of-arrays. Each column
+// holds one field for every transaction in append order; account numbers
+// and descriptions are interned once and referenced by 32-bit IDs.
+// TransactionJournal is a Singleton, like DataManager.
+class TransactionJournal
+{
+public:
+    static TransactionJournal &getInstance()
+    {
+        static TransactionJournal instance; // Guaranteed to be destroyed, instantiated on first use.
+        return instance;
+    }
+
+    TransactionJournal(const TransactionJournal &) = delete;
+    TransactionJournal &operator=(const TransactionJournal &) = delete;
+
+    uint32_t internAccount(const string &accountNumber)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        return intern(accountNumber, accountNumbers_, accountIndex_);
+    }
+
+    uint32_t internDescription(const string &description)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        return intern(description, descriptions_, descriptionIndex_);
+    }
+
+    // Appends one row and returns its position in the columns
+    size_t append(Transaction::Type type, Money amount, uint32_t accountId, const string &description)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        size_t row = ids_.size();
+        appendRow(type, amount, accountId, intern(description, descriptions_, descriptionIndex_));
+        return row;
+    }
+
+    // Appends one row stamped with an earlier time, for postings that belong
+    // to a past instant (lazily settled interest). The caller keeps each
+    // account's rows in timestamp order; the ID is assigned as usual.
+    size_t appendAt(Transaction::Type type, Money amount, uint32_t accountId, const string &description, time_t timestamp)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        size_t row = ids_.size();
+        appendRow(type, amount, accountId, intern(description, descriptions_, descriptionIndex_));
+        timestamps_.back() = min(timestamps_.back(), timestamp);
+        return row;
+    }
+
+    // The timestamp the next row would get; no row stamped later is older
+    time_t now()
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        return stamp();
+    }
+
+    // Appends the withdrawal and deposit legs of a transfer as two adjacent
+    // rows under one lock; returns the row of the withdrawal
+    size_t appendTransfer(uint32_t fromAccountId, uint32_t toAccountId, Money amount,
+                          const string &fromDescription, const string &toDescription)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        size_t row = ids_.size();
+        appendRow(Transaction::Type::WITHDRAWAL, amount, fromAccountId, intern(fromDescription, descriptions_, descriptionIndex_));
+        appendRow(Transaction::Type::DEPOSIT, amount, toAccountId, intern(toDescription, descriptions_, descriptionIndex_));
+        return row;
+    }
+
+    // Appends count rows of one type and description, one per account, under
+    // a single lock; returns the first row (rows are consecutive)
+    size_t appendBatch(Transaction::Type type, const uint32_t *accountIds, const int64_t *amounts,
+                       size_t count, const string &description)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        uint32_t descriptionId = intern(description, descriptions_, descriptionIndex_);
+        size_t row = ids_.size();
+        for (size_t i = 0; i < count; ++i)
+        {
+            appendRow(type, Money::fromMinorUnits(amounts[i]), accountIds[i], descriptionId);
+        }
+        return row;
+    }
+
+    // Appends count restored rows for one account, keeping their original
+    // IDs and timestamps; later IDs continue past the largest one. Returns
+    // the first row (rows are consecutive).
+    size_t appendRestored(uint32_t accountId, size_t count, const int64_t *ids, const int64_t *timestamps,
+                          const uint8_t *types, const int64_t *amounts, const uint32_t *descriptionIds)
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        size_t row = ids_.size();
+        ids_.insert(ids_.end(), ids, ids + count);
+        timestamps_.insert(timestamps_.end(), timestamps, timestamps + count);
+        types_.insert(types_.end(), types, types + count);
+        amounts_.insert(amounts_.end(), amounts, amounts + count);
+        accountIds_.insert(accountIds_.end(), count, accountId);
+        descriptionIds_.insert(descriptionIds_.end(), descriptionIds, descriptionIds + count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            nextId_ = max<long>(nextId_, static_cast<long>(ids[i]) + 1);
+            lastTimestamp_ = max(lastTimestamp_, static_cast<time_t>(timestamps[i]));
+        }
+        return row;
+    }
+
+    // Copies the given rows' columns out under one lock (snapshots)
+    void readRows(const size_t *rows, size_t count, int64_t *ids, int64_t *timestamps, uint8_t *types,
+                  int64_t *amounts, uint32_t *descriptionIds) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        for (size_t i = 0; i < count; ++i)
+        {
+            size_t row = rows[i];
+            ids[i] = ids_[row];
+            timestamps[i] = static_cast<int64_t>(timestamps_[row]);
+            types[i] = types_[row];
+            amounts[i] = amounts_[row];
+            descriptionIds[i] = descriptionIds_[row];
+        }
+    }
+
+    // Copies the columns of rows [first, first + count) out under one lock,
+    // for sequential scans of the whole journal (bulk export)
+    void readRange(size_t first, size_t count, int64_t *ids, int64_t *timestamps, uint8_t *types,
+                   int64_t *amounts, uint32_t *accountIds, uint32_t *descriptionIds) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        copy_n(ids_.begin() + first, count, ids);
+        copy_n(timestamps_.begin() + first, count, timestamps);
+        copy_n(types_.begin() + first, count, types);
+        copy_n(amounts_.begin() + first, count, amounts);
+        copy_n(accountIds_.begin() + first, count, accountIds);
+        copy_n(descriptionIds_.begin() + first, count, descriptionIds);
+    }
+
+    // ID and timestamp of a row, for the write-ahead log
+    void getStamp(size_t row, int64_t &id, int64_t &timestamp) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        id = ids_[row];
+        timestamp = static_cast<int64_t>(timestamps_[row]);
+    }
+
+    // Interned strings never move, so callers may keep these references
+    const string &getAccountNumber(uint32_t accountId) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return accountNumbers_[accountId];
+    }
+
+    const string &getDescription(uint32_t descriptionId) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return descriptions_[descriptionId];
+    }
+
+    size_t size() const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return ids_.size();
+    }
+
+    // size(), and the ID the next appended row will get, read together.
+    // Rows before the position have lower IDs than every row after it.
+    size_t getPosition(long &nextId) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        nextId = nextId_;
+        return ids_.size();
+    }
+
+    // --- Per-account index ---
+    // An account's rows are appended in posting order, and both IDs and
+    // timestamps never decrease along them, so an account's row list is
+    // searchable by either. Each returns the offset of the first of
+    // rows[0..count) whose ID / timestamp is >= the given one.
+    size_t lowerBoundById(const size_t *rows, size_t count, long id) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return static_cast<size_t>(lower_bound(rows, rows + count, id, [this](size_t row, long value)
+                                               { return ids_[row] < value; }) -
+                                   rows);
+    }
+
+    size_t lowerBoundByTime(const size_t *rows, size_t count, time_t timestamp) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return static_cast<size_t>(lower_bound(rows, rows + count, timestamp, [this](size_t row, time_t value)
+                                               { return timestamps_[row] < value; }) -
+                                   rows);
+    }
+
+    long getId(size_t row) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return ids_[row];
+    }
+
+    // Materializes a row; the strings it refers to live as long as the journal
+    Transaction getTransaction(size_t row) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return Transaction(ids_[row], timestamps_[row], static_cast<Transaction::Type>(types_[row]),
+                           Money::fromMinorUnits(amounts_[row]),
+                           accountNumbers_[accountIds_[row]], descriptions_[descriptionIds_[row]]);
+    }
+
+    // --- Column scans ---
+    Money totalByType(Transaction::Type type) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        const uint8_t wanted = static_cast<uint8_t>(type);
+        const size_t count = types_.size();
+        const uint8_t *types = types_.data();
+        const int64_t *amounts = amounts_.data();
+        int64_t total = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            total += (types[i] == wanted) ? amounts[i] : 0;
+        }
+        return Money::fromMinorUnits(total);
+    }
+
+    // Sum of amounts with from <= timestamp < to
+    Money totalBetween(time_t from, time_t to) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        const size_t count = timestamps_.size();
+        const time_t *timestamps = timestamps_.data();
+        const int64_t *amounts = amounts_.data();
+        int64_t total = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            total += (timestamps[i] >= from && timestamps[i] < to) ? amounts[i] : 0;
+        }
+        return Money::fromMinorUnits(total);
+    }
+
+    Money totalBetween(time_t from, time_t to, Transaction::Type type) const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        const uint8_t wanted = static_cast<uint8_t>(type);
+        const size_t count = timestamps_.size();
+        const time_t *timestamps = timestamps_.data();
+        const uint8_t *types = types_.data();
+        const int64_t *amounts = amounts_.data();
+        int64_t total = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            total += (types[i] == wanted && timestamps[i] >= from && timestamps[i] < to) ? amounts[i] : 0;
+        }
+        return Money::fromMinorUnits(total);
+    }
+
+    size_t getInternedStringCount() const
+    {
+        shared_lock<shared_mutex> lock(mutex_);
+        return accountNumbers_.size() + descriptions_.size();
+    }
+
+private:
+    TransactionJournal() {}
+
+    // Wall-clock time for new rows, held back from going below the newest
+    // row so timestamps never decrease in append order. Caller holds mutex_
+    // exclusively.
+    time_t stamp()
+    {
+        lastTimestamp_ = max(lastTimestamp_, time(nullptr));
+        return lastTimestamp_;
+    }
+
+    // Caller holds mutex_ exclusively
+    void appendRow(Transaction::Type type, Money amount, uint32_t accountId, uint32_t descriptionId)
+    {
+        ids_.push_back(nextId_++);
+        timestamps_.push_back(stamp());
+        types_.push_back(static_cast<uint8_t>(type));
+        amounts_.push_back(amount.getMinorUnits());
+        accountIds_.push_back(accountId);
+        descriptionIds_.push_back(descriptionId);
+    }
+
+    // Returns the ID of value in pool, adding it first if needed.
+    // Caller holds mutex_ exclusively.
+    static uint32_t intern(const string &value, deque<string> &pool, unordered_map<string_view, uint32_t> &index)
+    {
+        auto it = index.find(string_view(value));
+        if (it != index.end())
+        {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(pool.size());
+        pool.push_back(value);
+        index.emplace(string_view(pool.back()), id);
+        return id;
+    }
+
+    mutable shared_mutex mutex_;
+    long nextId_ = 1001;
+    time_t lastTimestamp_ = 0;
+
+    // Columns, one entry per transaction
+    vector<long> ids_;
+    vector<time_t> timestamps_;
+    vector<uint8_t> types_;
+    vector<int64_t> amounts_; // Money minor units
+    vector<uint32_t> accountIds_;
+    vector<uint32_t> descriptionIds_;
+
+    // Interned strings; deque keeps element addresses stable for the views
+    deque<string> accountNumbers_;
+    unordered_map<string_view, uint32_t> accountIndex_;
+    deque<string> descriptions_;
+    unordered_map<string_view, uint32_t> descriptionIndex_;
+};
+
+// Span over some of one account's rows in the journal, oldest first.
+// Spans from Account::getTransactionHistory and the *Unlocked queries point
+// into the account's row list, which moves as it grows: in thread-safe mode
+// use them only while holding Account::lock(). The locking Account queries
+// return a copy() instead, which owns its row numbers and stays valid for
+// good, since journal rows never change once appended.
+class TransactionHistory
+{
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = input_iterator_tag;
+        using value_type = Transaction;
+        using difference_type = ptrdiff_t;
+        using pointer = void;
+        using reference = Transaction;
+
+        const_iterator(const TransactionJournal *journal, const size_t *row) : journal_(journal), row_(row) {}
+
+        Transaction operator*() const { return journal_->getTransaction(*row_); }
+        const_iterator &operator++()
+        {
+            ++row_;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++row_;
+            return previous;
+        }
+        difference_type operator-(const const_iterator &other) const { return row_ - other.row_; }
+        bool operator==(const const_iterator &other) const { return row_ == other.row_; }
+        bool operator!=(const const_iterator &other) const { return row_ != other.row_; }
+
+    private:
+        const TransactionJournal *journal_;
+        const size_t *row_;
+    };
+
+    TransactionHistory(const TransactionJournal &journal, const vector<size_t> &rows)
+        : journal_(&journal), first_(rows.data()), last_(rows.data() + rows.size()) {}
+
+    TransactionHistory(const TransactionJournal &journal, const size_t *first, const size_t *last)
+        : journal_(&journal), first_(first), last_(last) {}
+
+    size_t size() const
+    {
+        return static_cast<size_t>(last_ - first_);
+    }
+
+    bool empty() const
+    {
+        return first_ == last_;
+    }
+
+    Transaction operator[](size_t index) const
+    {
+        return journal_->getTransaction(first_[index]);
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(journal_, first_);
+    }
+
+    const_iterator end() const
+    {
+        return const_iterator(journal_, last_);
+    }
+
+    // Journal row numbers of the transactions in this span, oldest first
+    const size_t *getRows() const
+    {
+        return first_;
+    }
+
+    size_t getRow(size_t index) const
+    {
+        return first_[index];
+    }
+
+    // The same transactions over a private copy of the row numbers
+    TransactionHistory copy() const
+    {
+        auto rows = make_shared<const vector<size_t>>(first_, last_);
+        TransactionHistory owned(*journal_, rows->data(), rows->data() + rows->size());
+        owned.owned_ = move(rows);
+        return owned;
+    }
+
+private:
+    const TransactionJournal *journal_;
+    const size_t *first_;
+    const size_t *last_;
+    shared_ptr<const vector<size_t>> owned_; // Backs first_/last_ for a copy()
+};
+
+// One page of a cursor-paginated history query. Cursors are transaction
+// IDs, so a cursor stays meaningful while new transactions arrive.
+struct TransactionPage
+{
+    TransactionHistory transactions;
+    long nextCursor; // Pass to the same query for the following page
+    bool hasMore;    // False once the history is exhausted in this direction
+};
+
+#endif // TRANSACTIONJOURNAL
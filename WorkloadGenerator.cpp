@@ -0,0 +1,244 @@
+#include <cstdint>
+#include <cstdio>    // For FILE
+#include <cstring>   // For memcmp
+#include <cmath>     // For pow
+#include <algorithm> // For lower_bound, shuffle
+#include <numeric>   // For iota
+#include <random>
+#include <string>
+#include <vector>
+#include <stdexcept> // For runtime_error
+using namespace std;
+
+#ifndef WORKLOADGENERATOR
+#define WORKLOADGENERATOR
+
+// One operation of a synthetic workload. Accounts are indexes into the
+// account list the trace is run against: [0, savingsCount) are savings
+// accounts and the rest checking accounts (see WorkloadConfig).
+struct WorkloadOp
+{
+    enum class Type : uint8_t
+    {
+        DEPOSIT,
+        WITHDRAWAL,
+        TRANSFER,
+        OVERDRAFT_ATTEMPT, // Checking withdrawal beyond balance plus overdraft limit; expected to fail
+        MAINTENANCE        // Bank::runMonthlyMaintenance
+    };
+    static const size_t TYPE_COUNT = 5;
+
+    Type type;
+    uint32_t account;
+    uint32_t otherAccount; // Transfer destination
+    int64_t amount;        // Minor units
+
+    static const char *getTypeName(Type type)
+    {
+        static const char *const names[TYPE_COUNT] = {"deposit", "withdrawal", "transfer", "overdraft_attempt", "maintenance"};
+        return names[static_cast<size_t>(type)];
+    }
+};
+
+struct WorkloadConfig
+{
+    size_t savingsCount = 0;
+    size_t checkingCount = 0;
+    double zipfExponent = 0.99; // 0 = uniform; around 1 = a few very hot accounts
+    // Relative weights of the operation mix
+    unsigned depositWeight = 40;
+    unsigned withdrawalWeight = 30;
+    unsigned transferWeight = 25;
+    unsigned overdraftWeight = 5;
+    size_t maintenanceInterval = 0; // A MAINTENANCE op after every this many ops; 0 = none
+    uint64_t seed = 1;
+};
+
+// Draws ranks 0..n-1 with P(rank k) proportional to 1 / (k + 1)^exponent
+// by binary search over a precomputed CDF
+class ZipfDistribution
+{
+public:
+    ZipfDistribution(size_t n, double exponent) : cdf_(n)
+    {
+        double total = 0.0;
+        for (size_t k = 0; k < n; ++k)
+        {
+            total += 1.0 / pow(static_cast<double>(k + 1), exponent);
+            cdf_[k] = total;
+        }
+        for (double &c : cdf_)
+        {
+            c /= total;
+        }
+    }
+
+    template <typename Random>
+    size_t operator()(Random &random) const
+    {
+        double u = uniform_real_distribution<double>(0.0, 1.0)(random);
+        size_t rank = static_cast<size_t>(lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+        return min(rank, cdf_.size() - 1);
+    }
+
+private:
+    vector<double> cdf_;
+};
+
+// Generates reproducible operation traces: the same config (seed included)
+// always yields the same trace. Hot ranks are spread over the account range
+// by a seeded permutation, so hot accounts are not simply the first ones.
+class WorkloadGenerator
+{
+public:
+    explicit WorkloadGenerator(const WorkloadConfig &config)
+        : config_(config),
+          accountCount_(config.savingsCount + config.checkingCount),
+          random_(config.seed),
+          allAccounts_(accountCount_ == 0 ? 1 : accountCount_, config.zipfExponent),
+          checkingAccounts_(config.checkingCount == 0 ? 1 : config.checkingCount, config.zipfExponent),
+          allRanks_(accountCount_),
+          checkingRanks_(config.checkingCount)
+    {
+        if (accountCount_ == 0)
+        {
+            throw invalid_argument("Workload needs at least one account");
+        }
+        iota(allRanks_.begin(), allRanks_.end(), 0);
+        shuffle(allRanks_.begin(), allRanks_.end(), random_);
+        iota(checkingRanks_.begin(), checkingRanks_.end(), static_cast<uint32_t>(config.savingsCount));
+        shuffle(checkingRanks_.begin(), checkingRanks_.end(), random_);
+    }
+
+    vector<WorkloadOp> generate(size_t count)
+    {
+        const unsigned overdraftWeight = config_.checkingCount == 0 ? 0 : config_.overdraftWeight;
+        const unsigned weights[4] = {config_.depositWeight, config_.withdrawalWeight, config_.transferWeight, overdraftWeight};
+        const unsigned totalWeight = weights[0] + weights[1] + weights[2] + weights[3];
+        if (totalWeight == 0)
+        {
+            throw invalid_argument("Workload mix has no operations");
+        }
+        vector<WorkloadOp> trace;
+        trace.reserve(count + (config_.maintenanceInterval == 0 ? 0 : count / config_.maintenanceInterval));
+        for (size_t i = 0; i < count; ++i)
+        {
+            unsigned pick = static_cast<unsigned>(random_() % totalWeight);
+            size_t kind = 0;
+            while (pick >= weights[kind])
+            {
+                pick -= weights[kind++];
+            }
+            WorkloadOp op = {};
+            op.type = static_cast<WorkloadOp::Type>(kind);
+            switch (op.type)
+            {
+            case WorkloadOp::Type::DEPOSIT:
+                op.account = allRanks_[allAccounts_(random_)];
+                op.amount = 100 + static_cast<int64_t>(random_() % 50000); // $1.00 - $500.99
+                break;
+            case WorkloadOp::Type::WITHDRAWAL:
+                op.account = allRanks_[allAccounts_(random_)];
+                op.amount = 100 + static_cast<int64_t>(random_() % 20000);
+                break;
+            case WorkloadOp::Type::TRANSFER:
+                op.account = allRanks_[allAccounts_(random_)];
+                // Redrawn until it differs: hot accounts would otherwise
+                // often pair with themselves, a no-op transfer under one lock
+                do
+                {
+                    op.otherAccount = allRanks_[allAccounts_(random_)];
+                } while (op.otherAccount == op.account && accountCount_ > 1);
+                op.amount = 100 + static_cast<int64_t>(random_() % 30000);
+                break;
+            default:
+                op.account = checkingRanks_[checkingAccounts_(random_)];
+                op.amount = OVERDRAFT_AMOUNT;
+                break;
+            }
+            trace.push_back(op);
+            if (config_.maintenanceInterval != 0 && (i + 1) % config_.maintenanceInterval == 0)
+            {
+                trace.push_back(WorkloadOp{WorkloadOp::Type::MAINTENANCE, 0, 0, 0});
+            }
+        }
+        return trace;
+    }
+
+    // --- Trace files ---
+    // Layout: 8-byte magic, u64 op count, then packed (u8 type, u32 account,
+    // u32 other account, i64 amount) records in host byte order
+    static void saveTrace(const string &path, const vector<WorkloadOp> &trace)
+    {
+        FILE *file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            throw runtime_error("Unable to create trace " + path);
+        }
+        uint64_t count = trace.size();
+        bool ok = fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file) == sizeof(TRACE_MAGIC) &&
+                  fwrite(&count, sizeof(count), 1, file) == 1;
+        for (size_t i = 0; ok && i < trace.size(); ++i)
+        {
+            const WorkloadOp &op = trace[i];
+            uint8_t type = static_cast<uint8_t>(op.type);
+            ok = fwrite(&type, 1, 1, file) == 1 && fwrite(&op.account, 4, 1, file) == 1 &&
+                 fwrite(&op.otherAccount, 4, 1, file) == 1 && fwrite(&op.amount, 8, 1, file) == 1;
+        }
+        ok = (fclose(file) == 0) && ok;
+        if (!ok)
+        {
+            throw runtime_error("Unable to write trace " + path);
+        }
+    }
+
+    static vector<WorkloadOp> loadTrace(const string &path)
+    {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            throw runtime_error("Unable to open trace " + path);
+        }
+        char magic[sizeof(TRACE_MAGIC)];
+        uint64_t count = 0;
+        if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0 ||
+            fread(&count, sizeof(count), 1, file) != 1)
+        {
+            fclose(file);
+            throw runtime_error(path + " is not a workload trace");
+        }
+        vector<WorkloadOp> trace;
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            WorkloadOp op = {};
+            uint8_t type = 0;
+            if (fread(&type, 1, 1, file) != 1 || fread(&op.account, 4, 1, file) != 1 ||
+                fread(&op.otherAccount, 4, 1, file) != 1 || fread(&op.amount, 8, 1, file) != 1 ||
+                type >= WorkloadOp::TYPE_COUNT)
+            {
+                fclose(file);
+                throw runtime_error("Trace " + path + " is truncated or corrupt");
+            }
+            op.type = static_cast<WorkloadOp::Type>(type);
+            trace.push_back(op);
+        }
+        fclose(file);
+        return trace;
+    }
+
+private:
+    static constexpr char TRACE_MAGIC[8] = {'B', 'A', 'N', 'K', 'T', 'R', 'C', '1'};
+    static const int64_t OVERDRAFT_AMOUNT = 1000000000000; // $10 billion, beyond any overdraft limit
+
+    WorkloadConfig config_;
+    size_t accountCount_;
+    mt19937_64 random_;
+    ZipfDistribution allAccounts_;
+    ZipfDistribution checkingAccounts_;
+    vector<uint32_t> allRanks_;      // Zipf rank -> account index
+    vector<uint32_t> checkingRanks_; // Zipf rank -> checking account index
+};
+
+constexpr char WorkloadGenerator::TRACE_MAGIC[8];
+
+#endif // WORKLOADGENERATOR
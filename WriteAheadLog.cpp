@@ -0,0 +1,482 @@
+#include <cstdint>
+#include <cstring> // For memcpy
+#include <cstdio>  // For FILE, fopen
+#include <cerrno>  // For errno
+#include <string>
+#include <string_view>
+#include <vector>
+#include <initializer_list>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <functional> // For the replay callback
+#include <stdexcept>  // For runtime_error
+#ifdef _WIN32
+#include <io.h> // For _commit, _chsize_s
+#else
+#include <unistd.h> // For fsync, ftruncate
+#endif
+using namespace std;
+
+#ifndef WRITEAHEADLOG
+#define WRITEAHEADLOG
+
+// One decoded WAL record: a type plus its string and integer fields in the
+// order they were appended
+struct WalRecord
+{
+    uint8_t type = 0;
+    uint64_t lsn = 0;
+    vector<string> texts;
+    vector<int64_t> values;
+};
+
+// Append-only binary journal of committed operations. Records are encoded
+// into an in-memory buffer by the calling thread; a committer thread writes
+// whatever has accumulated with one write and one fsync (group commit), so
+// concurrent operations share the cost of each sync.
+//
+// File layout: 8-byte magic ("BANKWAL" plus a format version), then records of
+//   [u32 payload length][u32 CRC-32 of payload][payload]
+// with payload = u8 type, u64 LSN, u32 text count, u32 value count,
+// texts as (u32 length, bytes), values as 8-byte integers (host byte order).
+// Postings carry the journal's transaction ID and timestamp so replay
+// restores them exactly, whatever order concurrent records were logged in.
+// A torn or corrupt tail is ignored on replay and cut off when the log is
+// reopened for writing. If a write or sync fails the log stops: nothing
+// later becomes durable, and waiters get the error as a runtime_error.
+class WriteAheadLog
+{
+public:
+    enum class RecordType : uint8_t
+    {
+        CUSTOMER_CREATED = 1,     // id, name, address, phone
+        SAVINGS_ACCOUNT_CREATED,  // account, owner | initial balance, rate ppm
+        CHECKING_ACCOUNT_CREATED, // account, owner | initial balance, overdraft limit
+        DEPOSIT,                  // account, description | amount, transaction ID, timestamp
+        WITHDRAWAL,               // account, description | amount, transaction ID, timestamp
+        TRANSFER,                 // from, to, description | amount, then ID and timestamp of each leg
+        INTEREST_CREDITS,         // account... | (amount, transaction ID, timestamp) per account
+        ACCOUNT_CLOSED,           // account
+        INTEREST_PERIOD_CLOSED,   // | close timestamp (lazy interest month-end)
+        INTEREST_SETTLED          // account | settled period count, then (amount, transaction ID, timestamp) per credit
+    };
+
+    enum class SyncMode
+    {
+        WAIT_FOR_COMMIT, // Operations return once their record is on disk
+        BACKGROUND       // Operations return at once; records reach disk within commitInterval
+    };
+
+    // Opens the log at path for appending, creating it if the file is
+    // missing or empty; throws if the file holds anything else.
+    // commitInterval is the longest a record waits in memory when nobody is
+    // waiting on it.
+    WriteAheadLog(const string &path, SyncMode mode = SyncMode::WAIT_FOR_COMMIT,
+                  chrono::microseconds commitInterval = chrono::microseconds(1000))
+        : path_(path), mode_(mode), commitInterval_(commitInterval)
+    {
+        uint64_t lastLsn = 0;
+        long validLength = scan(path, nullptr, lastLsn);
+        if (validLength < 0)
+        {
+            file_ = fopen(path.c_str(), "wb");
+            if (file_ == nullptr)
+            {
+                throw runtime_error("Unable to create WAL " + path);
+            }
+            if (fwrite(MAGIC, 1, sizeof(MAGIC), file_) != sizeof(MAGIC) || fflush(file_) != 0 || !syncFile())
+            {
+                fclose(file_);
+                throw runtime_error("Unable to write WAL " + path + ": " + strerror(errno));
+            }
+        }
+        else
+        {
+            file_ = fopen(path.c_str(), "r+b");
+            if (file_ == nullptr)
+            {
+                throw runtime_error("Unable to open WAL " + path);
+            }
+            truncateTo(validLength); // Drop any torn tail from a crash
+            fseek(file_, validLength, SEEK_SET);
+        }
+        nextLsn_ = lastLsn + 1;
+        durableLsn_ = lastLsn;
+        committer_ = thread(&WriteAheadLog::commitLoop, this);
+    }
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+    WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+    ~WriteAheadLog()
+    {
+        {
+            lock_guard<mutex> lock(mutex_);
+            stop_ = true;
+        }
+        commitNeeded_.notify_all();
+        committer_.join();
+        fclose(file_);
+    }
+
+    // Encodes a record into the pending buffer and returns its LSN. Call
+    // while holding whatever locks order the operation; call waitDurable
+    // after releasing them.
+    uint64_t append(RecordType type, initializer_list<string_view> texts, initializer_list<int64_t> values)
+    {
+        return appendRecord(type, texts, values);
+    }
+
+    uint64_t append(RecordType type, const vector<string_view> &texts, const vector<int64_t> &values)
+    {
+        return appendRecord(type, texts, values);
+    }
+
+    // In WAIT_FOR_COMMIT mode, blocks until the record with this LSN is on
+    // disk. The first waiter wakes the committer, and records appended while
+    // a sync is running are committed together in the next one.
+    // Throws runtime_error if the log failed before the record was synced.
+    void waitDurable(uint64_t lsn)
+    {
+        if (mode_ != SyncMode::WAIT_FOR_COMMIT || durableLsn_.load() >= lsn)
+        {
+            return;
+        }
+        unique_lock<mutex> lock(mutex_);
+        waitForLsn(lock, lsn);
+    }
+
+    // Writes and syncs everything appended so far; throws runtime_error if
+    // the log has failed
+    void commit()
+    {
+        unique_lock<mutex> lock(mutex_);
+        waitForLsn(lock, nextLsn_ - 1);
+    }
+
+    // Empty unless a write or sync has failed
+    string getError() const
+    {
+        lock_guard<mutex> lock(mutex_);
+        return error_;
+    }
+
+    uint64_t getLastLsn() const
+    {
+        lock_guard<mutex> lock(mutex_);
+        return nextLsn_ - 1;
+    }
+
+    uint64_t getDurableLsn() const
+    {
+        return durableLsn_.load();
+    }
+
+    uint64_t getCommitCount() const
+    {
+        return commitCount_.load();
+    }
+
+    const string &getPath() const
+    {
+        return path_;
+    }
+
+    // Reads every intact record in order and calls apply for each one with
+    // LSN > afterLsn. Returns the number of records applied; a missing file
+    // counts as an empty log.
+    static size_t replay(const string &path, const function<void(const WalRecord &)> &apply, uint64_t afterLsn = 0)
+    {
+        size_t applied = 0;
+        uint64_t lastLsn = 0;
+        scan(path, [&](const WalRecord &record)
+             {
+                 if (record.lsn > afterLsn)
+                 {
+                     apply(record);
+                     ++applied;
+                 } },
+             lastLsn);
+        return applied;
+    }
+
+private:
+    // Version 2: postings carry transaction IDs and timestamps
+    static constexpr char MAGIC[8] = {'B', 'A', 'N', 'K', 'W', 'A', 'L', '2'};
+    static const size_t FLUSH_THRESHOLD = 1 << 20; // Commit early once this much is pending
+    static const uint32_t MAX_RECORD_SIZE = 1 << 26;
+
+    template <typename Texts, typename Values>
+    uint64_t appendRecord(RecordType type, const Texts &texts, const Values &values)
+    {
+        lock_guard<mutex> lock(mutex_);
+        uint64_t lsn = nextLsn_++;
+        size_t start = pending_.size();
+        pending_.resize(start + 8); // Length and CRC, filled in below
+        put<uint8_t>(static_cast<uint8_t>(type));
+        put<uint64_t>(lsn);
+        put<uint32_t>(static_cast<uint32_t>(texts.size()));
+        put<uint32_t>(static_cast<uint32_t>(values.size()));
+        for (string_view text : texts)
+        {
+            put<uint32_t>(static_cast<uint32_t>(text.size()));
+            pending_.insert(pending_.end(), text.begin(), text.end());
+        }
+        for (int64_t value : values)
+        {
+            put<int64_t>(value);
+        }
+        uint32_t length = static_cast<uint32_t>(pending_.size() - start - 8);
+        uint32_t crc = crc32(&pending_[start + 8], length);
+        memcpy(&pending_[start], &length, 4);
+        memcpy(&pending_[start + 4], &crc, 4);
+        if (pending_.size() >= FLUSH_THRESHOLD)
+        {
+            commitNeeded_.notify_one();
+        }
+        return lsn;
+    }
+
+    // Wakes the committer and blocks until lsn is durable or the log fails
+    void waitForLsn(unique_lock<mutex> &lock, uint64_t lsn)
+    {
+        ++waiters_;
+        commitNeeded_.notify_one();
+        committed_.wait(lock, [&]
+                        { return durableLsn_.load() >= lsn || !error_.empty(); });
+        --waiters_;
+        if (durableLsn_.load() < lsn)
+        {
+            throw runtime_error("Write-ahead log " + path_ + " failed: " + error_);
+        }
+    }
+
+    template <typename T>
+    void put(T value)
+    {
+        size_t at = pending_.size();
+        pending_.resize(at + sizeof(T));
+        memcpy(&pending_[at], &value, sizeof(T));
+    }
+
+    void commitLoop()
+    {
+        vector<char> writing;
+        unique_lock<mutex> lock(mutex_);
+        while (true)
+        {
+            commitNeeded_.wait_for(lock, commitInterval_, [this]
+                                   { return stop_ || (!pending_.empty() && (waiters_ > 0 || pending_.size() >= FLUSH_THRESHOLD)); });
+            if (pending_.empty())
+            {
+                if (stop_)
+                {
+                    break;
+                }
+                continue;
+            }
+            writing.swap(pending_);
+            uint64_t lsn = nextLsn_ - 1;
+            if (!error_.empty())
+            {
+                writing.clear(); // Failed earlier: nothing more reaches the file
+                continue;
+            }
+            lock.unlock();
+
+            const char *failed = nullptr;
+            if (fwrite(writing.data(), 1, writing.size(), file_) != writing.size())
+            {
+                failed = "write";
+            }
+            else if (fflush(file_) != 0)
+            {
+                failed = "flush";
+            }
+            else if (!syncFile())
+            {
+                failed = "sync";
+            }
+            const int errorCode = errno;
+            writing.clear();
+            ++commitCount_;
+
+            lock.lock();
+            if (failed != nullptr)
+            {
+                // The file may hold part of the batch; stop rather than
+                // let later records land after a gap
+                error_ = string(failed) + " error: " + strerror(errorCode);
+            }
+            else
+            {
+                durableLsn_.store(lsn);
+            }
+            committed_.notify_all();
+        }
+    }
+
+    bool syncFile()
+    {
+#ifdef _WIN32
+        return _commit(_fileno(file_)) == 0;
+#else
+        return fsync(fileno(file_)) == 0;
+#endif
+    }
+
+    void truncateTo(long length)
+    {
+#ifdef _WIN32
+        _chsize_s(_fileno(file_), length);
+#else
+        if (ftruncate(fileno(file_), length) != 0)
+        {
+            throw runtime_error("Unable to truncate WAL " + path_);
+        }
+#endif
+    }
+
+    // Walks the file, decoding intact records. Returns the length of the
+    // valid prefix, or -1 if the file does not exist or stops inside the
+    // magic (a log whose creation was cut short). Throws if the file is
+    // something else, including a log in another format version.
+    static long scan(const string &path, const function<void(const WalRecord &)> &onRecord, uint64_t &lastLsn)
+    {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return -1;
+        }
+        char magic[sizeof(MAGIC)];
+        size_t magicLength = fread(magic, 1, sizeof(magic), file);
+        if (memcmp(magic, MAGIC, magicLength) != 0)
+        {
+            fclose(file);
+            throw runtime_error("Not a write-ahead log in this format: " + path);
+        }
+        if (magicLength != sizeof(MAGIC))
+        {
+            fclose(file);
+            return -1;
+        }
+        long valid = sizeof(MAGIC);
+        vector<char> payload;
+        WalRecord record;
+        while (true)
+        {
+            uint32_t header[2];
+            if (fread(header, 1, sizeof(header), file) != sizeof(header))
+            {
+                break;
+            }
+            if (header[0] > MAX_RECORD_SIZE)
+            {
+                break; // A corrupt length, not a record
+            }
+            payload.resize(header[0]);
+            if (fread(payload.data(), 1, header[0], file) != header[0] || crc32(payload.data(), header[0]) != header[1] ||
+                !decode(payload, record))
+            {
+                break;
+            }
+            valid += static_cast<long>(sizeof(header) + header[0]);
+            lastLsn = record.lsn;
+            if (onRecord)
+            {
+                onRecord(record);
+            }
+        }
+        fclose(file);
+        return valid;
+    }
+
+    static bool decode(const vector<char> &payload, WalRecord &record)
+    {
+        size_t at = 0;
+        auto take = [&](void *out, size_t size)
+        {
+            if (at + size > payload.size())
+            {
+                return false;
+            }
+            memcpy(out, &payload[at], size);
+            at += size;
+            return true;
+        };
+        uint32_t textCount = 0, valueCount = 0;
+        if (!take(&record.type, 1) || !take(&record.lsn, 8) || !take(&textCount, 4) || !take(&valueCount, 4) ||
+            textCount > payload.size() || valueCount > payload.size())
+        {
+            return false;
+        }
+        record.texts.resize(textCount);
+        for (string &text : record.texts)
+        {
+            uint32_t length = 0;
+            if (!take(&length, 4) || at + length > payload.size())
+            {
+                return false;
+            }
+            text.assign(&payload[at], length);
+            at += length;
+        }
+        record.values.resize(valueCount);
+        for (int64_t &value : record.values)
+        {
+            if (!take(&value, 8))
+            {
+                return false;
+            }
+        }
+        return at == payload.size();
+    }
+
+    static uint32_t crc32(const char *data, size_t length)
+    {
+        static const vector<uint32_t> table = []
+        {
+            vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+        uint32_t crc = 0xFFFFFFFFu;
+        for (size_t i = 0; i < length; ++i)
+        {
+            crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+        }
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    string path_;
+    SyncMode mode_;
+    chrono::microseconds commitInterval_;
+    FILE *file_ = nullptr;
+
+    mutable mutex mutex_;
+    condition_variable commitNeeded_;
+    condition_variable committed_;
+    vector<char> pending_; // Encoded records not yet handed to the committer
+    uint64_t nextLsn_ = 1;
+    atomic<uint64_t> durableLsn_{0};
+    atomic<uint64_t> commitCount_{0};
+    size_t waiters_ = 0;
+    bool stop_ = false;
+    string error_; // Why the log stopped; empty while it works
+    thread committer_;
+};
+
+constexpr char WriteAheadLog::MAGIC[8];
+
+#endif // WRITEAHEADLOG
@@ -3,8 +3,28 @@
 #include <limits> // For numeric_limits
 #include <iomanip> // For fixed, setprecision
 #include <vector>  // Ensure vector is included for clarity
+#include <thread>  // For the concurrent transfer check
+#include <random>  // For picking random transfers
+#include <algorithm> // For count
+#include <atomic>  // For stopping the snapshot reporter
+#include <cstdio>  // For remove
+#include <filesystem> // For the durability and snapshot checks' files
+#include <fstream> // For damaging a snapshot copy
+#include <cstddef> // For offsetof
+#include <chrono>  // For letting writers start before a snapshot
+#include <sstream> // For rendering log entries to compare
+#include <map>     // For the export check's opening balances
+#include <iterator> // For istreambuf_iterator
+#include <ctime>   // For time
+#ifdef _WIN32
+#include <process.h> // For _getpid
+#else
+#include <unistd.h> // For getpid
+#endif
 #include "Bank.cpp" // For Bank class
 #include "DataManager.cpp" // For DataManager singleton
+#include "StatementExporter.cpp" // For the export check
+#include "BulkExporter.cpp" // For the export check
 using namespace std;
 
 // Helper function to print a separator for better readability in console output
@@ -12,10 +32,40 @@ void printSeparator() {
     cout << "\n-----------------------------------------\n";
 }
 
+long long processId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return getpid();
+#endif
+}
+
+// A file in the temp directory named for this process, so demos run side
+// by side don't overwrite each other's logs and snapshots
+filesystem::path demoTempPath(const string& name) {
+    return filesystem::temp_directory_path() / ("bankapp-" + to_string(processId()) + "-" + name);
+}
+
+// Differences between two banks that should hold the same accounts:
+// accounts missing from actual, balances and history lengths
+size_t countStateMismatches(const Bank& expected, const Bank& actual) {
+    const vector<Account*> expectedAccounts = expected.getAllAccounts();
+    size_t mismatches = (expectedAccounts.size() == actual.getAllAccounts().size()) ? 0 : 1;
+    for (Account* account : expectedAccounts) {
+        Account* other = actual.getAccount(account->getAccountNumber());
+        if (*other == *(InvalidAccount::getInstance()) || other->getBalance() != account->getBalance() ||
+            other->getTransactionHistory().size() != account->getTransactionHistory().size()) {
+            ++mismatches;
+        }
+    }
+    return mismatches;
+}
+
 int main() {
     // Get the DataManager instance for logging setup
     // DataManager is a Singleton, so we get its single instance
     DataManager& dataManager = DataManager::getInstance();
+    dataManager.setMetricsEnabled(true);
     
     cout << "--- C++ Banking System Simulation ---\n";
 
@@ -24,9 +74,9 @@ int main() {
     printSeparator();
 
     // 2. Create Customers
-    Customer cust1 = myBank.createCustomer("Alice Smith", "123 Main St", "555-1111");
-    Customer cust2 = myBank.createCustomer("Bob Johnson", "456 Oak Ave", "555-2222");
-    Customer cust3 = myBank.createCustomer("Charlie Brown", "789 Pine Ln", "555-3333");
+    const Customer &cust1 = myBank.createCustomer("Alice Smith", "123 Main St", "555-1111");
+    const Customer &cust2 = myBank.createCustomer("Bob Johnson", "456 Oak Ave", "555-2222");
+    const Customer &cust3 = myBank.createCustomer("Charlie Brown", "789 Pine Ln", "555-3333");
     printSeparator();
 
     // Verify customers were created
@@ -34,17 +84,23 @@ int main() {
     cout << cust1 << endl;
     cout << cust2 << endl;
     cout << cust3 << endl;
+    cout << "Customers whose name starts with \"b\":";
+    for (const Customer *match : myBank.findCustomersByNamePrefix("b", 10))
+    {
+        cout << " " << match->getName() << " (" << match->getCustomerId() << ")";
+    }
+    cout << "\n";
     printSeparator();
 
     // 3. Create Accounts for Customers
-    Account aliceSavings = myBank.createSavingsAccount(cust1.getCustomerId(), 1000.00, 0.01); // 1% interest
-    Account aliceChecking = myBank.createCheckingAccount(cust1.getCustomerId(), 500.00, 200.00); // $200 overdraft
+    Account &aliceSavings = myBank.createSavingsAccount(cust1.getCustomerId(), Money::fromDouble(1000.00), InterestRate::fromDouble(0.01)); // 1% interest
+    Account &aliceChecking = myBank.createCheckingAccount(cust1.getCustomerId(), Money::fromDouble(500.00), Money::fromDouble(200.00)); // $200 overdraft
     
-    Account bobChecking = myBank.createCheckingAccount(cust2.getCustomerId(), 2000.00, 500.00);
-    Account bobSavings = myBank.createSavingsAccount(cust2.getCustomerId(), 5000.00, 0.015); // 1.5% interest
+    Account &bobChecking = myBank.createCheckingAccount(cust2.getCustomerId(), Money::fromDouble(2000.00), Money::fromDouble(500.00));
+    Account &bobSavings = myBank.createSavingsAccount(cust2.getCustomerId(), Money::fromDouble(5000.00), InterestRate::fromDouble(0.015)); // 1.5% interest
 
     // Charlie only has a checking account for now
-    Account charlieChecking = myBank.createCheckingAccount(cust3.getCustomerId(), 100.00, 100.00);
+    Account &charlieChecking = myBank.createCheckingAccount(cust3.getCustomerId(), Money::fromDouble(100.00), Money::fromDouble(100.00));
     printSeparator();
 
     // Display initial account states
@@ -61,21 +117,21 @@ int main() {
     
     // Deposit to Alice's Savings
     cout << "Alice deposits $200 into Savings.\n";
-    if (aliceSavings.deposit(200.00, "Cash deposit")) {
+    if (aliceSavings.deposit(Money::fromDouble(200.00), "Cash deposit")) {
         cout << "Alice's Savings Balance: $" << fixed << setprecision(2) << aliceSavings.getBalance() << "\n";
     }
     printSeparator();
 
     // Withdraw from Bob's Checking
     cout << "Bob withdraws $300 from Checking.\n";
-    if (bobChecking.withdraw(300.00, "ATM withdrawal")) {
+    if (bobChecking.withdraw(Money::fromDouble(300.00), "ATM withdrawal")) {
         cout << "Bob's Checking Balance: $" << fixed << setprecision(2) << bobChecking.getBalance() << "\n";
     }
     printSeparator();
 
     // Attempt an overdraft withdrawal from Charlie's Checking
     cout << "Charlie attempts to withdraw $250 from Checking (balance $100, overdraft $100).\n";
-    if (charlieChecking.withdraw(250.00, "Large purchase")) {
+    if (charlieChecking.withdraw(Money::fromDouble(250.00), "Large purchase")) {
         // This should fail, so this block should not execute
         cout << "Charlie's Checking Balance: $" << fixed << setprecision(2) << charlieChecking.getBalance() << "\n";
     } else {
@@ -85,7 +141,7 @@ int main() {
 
     // Successful overdraft withdrawal from Charlie's Checking
     cout << "Charlie attempts to withdraw $150 from Checking (balance $100, overdraft $100 -> total $200 available).\n";
-    if (charlieChecking.withdraw(150.00, "Small purchase")) {
+    if (charlieChecking.withdraw(Money::fromDouble(150.00), "Small purchase")) {
         cout << "Charlie's Checking Balance: $" << fixed << setprecision(2) << charlieChecking.getBalance() << "\n";
     } else {
         cout << "Charlie's withdrawal failed.\n"; // This should not happen now
@@ -94,7 +150,7 @@ int main() {
 
     // Transfer funds between accounts
     cout << "Transferring $150 from Bob's Checking to Alice's Checking.\n";
-    if (myBank.transferFunds(bobChecking.getAccountNumber(), aliceChecking.getAccountNumber(), 150.00, "Gift")) {
+    if (myBank.transferFunds(bobChecking.getAccountNumber(), aliceChecking.getAccountNumber(), Money::fromDouble(150.00), "Gift")) {
         cout << "Bob's Checking Balance: $" << fixed << setprecision(2) << bobChecking.getBalance() << "\n";
         cout << "Alice's Checking Balance: $" << fixed << setprecision(2) << aliceChecking.getBalance() << "\n";
     } else {
@@ -120,7 +176,7 @@ int main() {
     // 6. Display Transaction Histories
     cout << "--- Transaction Histories ---\n";
     cout << "Alice's Savings Account (" << aliceSavings.getAccountNumber() << ") Transactions:\n";
-    vector<Transaction> transactionHistory = aliceSavings.getTransactionHistory();
+    TransactionHistory transactionHistory = aliceSavings.getTransactionHistory();
     for (size_t i = 0; i < transactionHistory.size(); ++i) {
         cout << "  " << transactionHistory[i] << "\n";
     }
@@ -131,6 +187,21 @@ int main() {
         cout << "  " << trx << "\n";
     }
     printSeparator();
+
+    // History queries return spans over the account's rows, found by binary search
+    cout << "Alice's latest 2 transactions:\n";
+    for (const auto& trx : aliceSavings.getLatestTransactions(2)) {
+        cout << "  " << trx << "\n";
+    }
+    cout << "Alice's history, 2 per page:\n";
+    TransactionPage page{TransactionHistory(TransactionJournal::getInstance(), nullptr, nullptr), 0, true};
+    for (int pageNumber = 1; page.hasMore; ++pageNumber) {
+        page = aliceSavings.getTransactionsAfter(page.nextCursor, 2);
+        for (const auto& trx : page.transactions) {
+            cout << "  page " << pageNumber << ": " << trx << "\n";
+        }
+    }
+    printSeparator();
     
     // Can also get all accounts and print transactions for each
     cout << "--- All Account Transaction Histories (Summary) ---\n";
@@ -147,13 +218,801 @@ int main() {
 
     // 7. Display all logged events
     cout << "--- All System Logs ---\n";
-    // Store the returned vector in a local const variable to ensure its lifetime
-    const vector<DataLogEntry> allLogs = dataManager.getAllLogs();
-    for (const auto& entry : allLogs) {
+    // The view reads the stored entries in place; nothing is copied
+    for (const auto& entry : dataManager.getLogs()) {
         cout << entry << "\n";
     }
     printSeparator();
 
+    cout << "--- Logs for " << cust1.getCustomerId() << " and warnings ---\n";
+    for (const auto& entry : dataManager.getLogsFor(cust1.getCustomerId())) {
+        cout << entry << "\n";
+    }
+    LogView warnings = dataManager.getLogsByLevel(DataLogEntry::LogLevel::WARNING);
+    cout << warnings.size() << " warnings";
+    if (!warnings.empty()) {
+        cout << ", first: " << warnings[0].getDescription();
+    }
+    cout << "\n";
+    printSeparator();
+
+    // 8. Concurrent transfer stress check
+    // Many threads move random amounts between random accounts; the total
+    // held by the bank must be the same afterwards.
+    cout << "--- Concurrent Transfer Stress Check ---\n";
+    myBank.setThreadSafe(true);
+    dataManager.setMinLevel(DataLogEntry::LogLevel::ERROR); // Keep the console readable
+    const vector<Account*> stressAccounts = myBank.getAllAccounts();
+    Money totalBefore;
+    for (Account* acc_ptr : stressAccounts) {
+        totalBefore += acc_ptr->getBalance();
+    }
+
+    const unsigned threadCount = 8;
+    const int transfersPerThread = 20000;
+    vector<thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            mt19937 rng(t + 1);
+            uniform_int_distribution<size_t> pickAccount(0, stressAccounts.size() - 1);
+            uniform_int_distribution<int64_t> pickCents(1, 50000);
+            for (int i = 0; i < transfersPerThread; ++i) {
+                const string from = stressAccounts[pickAccount(rng)]->getAccountNumber();
+                const string to = stressAccounts[pickAccount(rng)]->getAccountNumber();
+                myBank.transferFunds(from, to, Money::fromMinorUnits(pickCents(rng)), "Stress");
+            }
+        });
+    }
+    // A reporter takes balance snapshots while the transfers run; each one
+    // must add up to the same total even though it never stops the workers
+    atomic<bool> transfersDone(false);
+    size_t snapshotsTaken = 0;
+    size_t snapshotsInconsistent = 0;
+    thread reporter([&]() {
+        while (!transfersDone.load()) {
+            BalanceSnapshot snapshot = myBank.takeBalanceSnapshot();
+            ++snapshotsTaken;
+            if (snapshot.getTotal() != totalBefore) {
+                ++snapshotsInconsistent;
+            }
+        }
+    });
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    transfersDone.store(true);
+    reporter.join();
+
+    // The same workload as one settlement batch, split into conflict-free groups
+    mt19937 batchRng(42);
+    uniform_int_distribution<size_t> pickBatchAccount(0, stressAccounts.size() - 1);
+    uniform_int_distribution<int64_t> pickBatchCents(1, 50000);
+    vector<Bank::TransferRequest> settlementBatch;
+    for (int i = 0; i < transfersPerThread; ++i) {
+        settlementBatch.push_back({stressAccounts[pickBatchAccount(batchRng)]->getAccountNumber(),
+                                   stressAccounts[pickBatchAccount(batchRng)]->getAccountNumber(),
+                                   Money::fromMinorUnits(pickBatchCents(batchRng)), "Settlement"});
+    }
+    vector<Bank::TransferStatus> batchStatus = myBank.applyTransfers(settlementBatch, threadCount);
+    size_t batchSucceeded = count(batchStatus.begin(), batchStatus.end(), Bank::TransferStatus::OK);
+
+    Money totalAfter;
+    for (Account* acc_ptr : stressAccounts) {
+        totalAfter += acc_ptr->getBalance();
+    }
+    dataManager.setMinLevel(DataLogEntry::LogLevel::INFO);
+    myBank.setThreadSafe(false);
+    cout << threadCount * transfersPerThread << " transfers on " << threadCount << " threads\n";
+    cout << "Settlement batch: " << batchSucceeded << " of " << settlementBatch.size() << " transfers applied\n";
+    cout << "Balance snapshots during transfers: " << snapshotsTaken << " ("
+         << snapshotsInconsistent << " inconsistent)\n";
+    cout << "Total before: $" << totalBefore << ", total after: $" << totalAfter << "\n";
+    if (snapshotsInconsistent != 0) {
+        cout << "ERROR: a balance snapshot saw a transfer half-applied\n";
+        return 1;
+    }
+    if (totalBefore != totalAfter) {
+        cout << "ERROR: money was not conserved\n";
+        return 1;
+    }
+    cout << "Money conserved.\n";
+
+    // Running totals are maintained by every posting; recompute them once to check
+    if (!myBank.verifyBalanceTotals()) {
+        cout << "ERROR: running balance totals drifted from the accounts\n";
+        return 1;
+    }
+    const BalanceAggregates::Totals bankTotals = myBank.getBalanceTotals();
+    cout << "Running totals: " << bankTotals.accountCount << " accounts, $" << bankTotals.getNetBalance()
+         << " net, checking overdraft exposure $"
+         << myBank.getBalanceTotals(Account::Kind::CHECKING).overdraftExposure << "\n";
+    cout << cust1.getName() << " net worth: $" << myBank.getCustomerNetWorth(cust1.getCustomerId()) << "\n";
+    printSeparator();
+
+    // 9. Batch transfer equivalence check
+    // Two banks start with the same accounts; one applies a batch of random
+    // transfers with applyTransfers, the other runs the same requests one by
+    // one through transferFunds. Every outcome, final balance and transfer
+    // or overdraft counter must match.
+    cout << "--- Batch Transfer Equivalence Check ---\n";
+    {
+        const size_t accountCount = 64;
+        const size_t batchSize = 50000;
+        dataManager.setSink(DataManager::LogSink::NONE); // Failed transfers log errors
+        Bank batchBank("Batch Bank");
+        Bank sequentialBank("Sequential Bank");
+        vector<string> batchNumbers, sequentialNumbers;
+        mt19937 setupRng(7);
+        uniform_int_distribution<int64_t> pickOpening(0, 200000);
+        for (size_t i = 0; i < accountCount; ++i) {
+            const Money opening = Money::fromMinorUnits(pickOpening(setupRng));
+            for (Bank* bank : {&batchBank, &sequentialBank}) {
+                const string owner = bank->createCustomer("Equivalence " + to_string(i), "1 Test Rd", "555-0000").getCustomerId();
+                Account& account = (i % 2 == 0)
+                    ? bank->createSavingsAccount(owner, opening, InterestRate::fromDouble(0.01))
+                    : bank->createCheckingAccount(owner, opening, Money::fromDouble(250.00));
+                (bank == &batchBank ? batchNumbers : sequentialNumbers).push_back(account.getAccountNumber());
+            }
+        }
+
+        // Indices past the last account stand for unknown account numbers;
+        // some amounts are zero to exercise the invalid-amount path
+        mt19937 requestRng(2024);
+        uniform_int_distribution<size_t> pickIndex(0, accountCount);
+        uniform_int_distribution<int64_t> pickCents(0, 80000);
+        auto number = [](const vector<string>& numbers, size_t index) {
+            return index < numbers.size() ? numbers[index] : string("ACC-UNKNOWN");
+        };
+        vector<Bank::TransferRequest> batchRequests;
+        vector<Bank::TransferRequest> sequentialRequests;
+        batchRequests.reserve(batchSize);
+        sequentialRequests.reserve(batchSize);
+        for (size_t i = 0; i < batchSize; ++i) {
+            const size_t from = pickIndex(requestRng), to = pickIndex(requestRng);
+            const Money amount = Money::fromMinorUnits(pickCents(requestRng));
+            batchRequests.push_back({number(batchNumbers, from), number(batchNumbers, to), amount, "Equivalence"});
+            sequentialRequests.push_back({number(sequentialNumbers, from), number(sequentialNumbers, to), amount, "Equivalence"});
+        }
+
+        const Metrics::Counter countersToMatch[] = {
+            Metrics::Counter::TRANSFERS, Metrics::Counter::TRANSFERS_INVALID_AMOUNT,
+            Metrics::Counter::TRANSFERS_SOURCE_NOT_FOUND, Metrics::Counter::TRANSFERS_DESTINATION_NOT_FOUND,
+            Metrics::Counter::TRANSFERS_INSUFFICIENT_FUNDS, Metrics::Counter::OVERDRAFTS_INCURRED,
+            Metrics::Counter::OVERDRAFT_LIMIT_EXCEEDED};
+        const Metrics::Snapshot beforeBatch = dataManager.getMetrics();
+        batchBank.setThreadSafe(true);
+        const vector<Bank::TransferStatus> batchResults = batchBank.applyTransfers(batchRequests, threadCount);
+        batchBank.setThreadSafe(false);
+        const Metrics::Snapshot afterBatch = dataManager.getMetrics();
+        size_t outcomeMismatches = 0;
+        size_t applied = 0;
+        for (size_t i = 0; i < batchSize; ++i) {
+            const Bank::TransferRequest& request = sequentialRequests[i];
+            const bool ok = sequentialBank.transferFunds(request.fromAccount, request.toAccount, request.amount, request.description);
+            applied += ok ? 1 : 0;
+            if (ok != (batchResults[i] == Bank::TransferStatus::OK)) {
+                ++outcomeMismatches;
+            }
+        }
+        const Metrics::Snapshot afterSequential = dataManager.getMetrics();
+        size_t counterMismatches = 0;
+        for (Metrics::Counter counter : countersToMatch) {
+            const uint64_t batchCount = afterBatch.getCounter(counter) - beforeBatch.getCounter(counter);
+            const uint64_t sequentialCount = afterSequential.getCounter(counter) - afterBatch.getCounter(counter);
+            if (batchCount != sequentialCount) {
+                cout << "Counter " << Metrics::getCounterName(counter) << ": batch " << batchCount
+                     << ", sequential " << sequentialCount << "\n";
+                ++counterMismatches;
+            }
+        }
+        size_t balanceMismatches = 0;
+        for (size_t i = 0; i < accountCount; ++i) {
+            if (batchBank.getAccount(batchNumbers[i])->getBalance() !=
+                sequentialBank.getAccount(sequentialNumbers[i])->getBalance()) {
+                ++balanceMismatches;
+            }
+        }
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+        cout << batchSize << " transfers over " << accountCount << " accounts, " << applied << " applied: "
+             << outcomeMismatches << " outcome, " << balanceMismatches << " balance and " << counterMismatches
+             << " counter mismatches\n";
+        if (outcomeMismatches != 0 || balanceMismatches != 0 || counterMismatches != 0) {
+            cout << "ERROR: applyTransfers disagrees with sequential transferFunds\n";
+            return 1;
+        }
+        cout << "Batch matches sequential.\n";
+    }
+    printSeparator();
+
+    // 10. Interest kernel check
+    // Month-end maintenance computes interest for whole chunks of savings
+    // accounts with Ledger::computeInterest; crediting each account on its
+    // own with applyInterest must give the same cents.
+    cout << "--- Interest Kernel Check ---\n";
+    {
+        const size_t accountCount = 20000;
+        dataManager.setSink(DataManager::LogSink::NONE);
+        Bank kernelBank("Kernel Bank");
+        Bank perAccountBank("Per-Account Bank");
+        vector<SavingsAccount*> kernelAccounts, perAccountAccounts;
+        mt19937_64 interestRng(11);
+        const string kernelOwner = kernelBank.createCustomer("Kernel Check", "1 Test Rd", "555-0000").getCustomerId();
+        const string perAccountOwner = perAccountBank.createCustomer("Kernel Check", "1 Test Rd", "555-0000").getCustomerId();
+        for (size_t i = 0; i < accountCount; ++i) {
+            // Mostly everyday balances, some at half-cent ties and some too
+            // large for the vector kernel's exact range
+            int64_t cents = static_cast<int64_t>(interestRng() % 100000000);
+            int64_t ppm = static_cast<int64_t>(interestRng() % 60000);
+            if (i % 10 == 0) {
+                cents = static_cast<int64_t>(interestRng() % 1000) * 2 + 1;
+                ppm = 500000;
+            } else if (i % 1000 == 1) {
+                cents = (int64_t(1) << 52) + static_cast<int64_t>(interestRng() % 1000000);
+            }
+            kernelAccounts.push_back(static_cast<SavingsAccount*>(&kernelBank.createSavingsAccount(
+                kernelOwner, Money::fromMinorUnits(cents), InterestRate::fromPartsPerMillion(ppm))));
+            perAccountAccounts.push_back(static_cast<SavingsAccount*>(&perAccountBank.createSavingsAccount(
+                perAccountOwner, Money::fromMinorUnits(cents), InterestRate::fromPartsPerMillion(ppm))));
+        }
+        kernelBank.runMonthlyMaintenance();
+        for (SavingsAccount* account : perAccountAccounts) {
+            account->applyInterest();
+        }
+        size_t interestMismatches = 0;
+        for (size_t i = 0; i < accountCount; ++i) {
+            if (kernelAccounts[i]->getBalance() != perAccountAccounts[i]->getBalance()) {
+                ++interestMismatches;
+            }
+        }
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+        cout << accountCount << " savings accounts, " << interestMismatches << " interest mismatches ("
+             << (BANK_VECTOR_INTEREST ? "vector" : "scalar") << " kernel)\n";
+        if (interestMismatches != 0) {
+            cout << "ERROR: Ledger::computeInterest disagrees with SavingsAccount::applyInterest\n";
+            return 1;
+        }
+        cout << "Kernel matches per-account interest.\n";
+    }
+    printSeparator();
+
+    // 11. Lazy interest check
+    // One bank credits interest at every month-end, the other closes the
+    // month and lets each account settle when it is next read. After the
+    // same postings, history queries and running totals must agree, even
+    // on accounts nothing touched since the last month-end.
+    cout << "--- Lazy Interest Check ---\n";
+    {
+        const size_t customerCount = 200;
+        const int months = 3;
+        dataManager.setSink(DataManager::LogSink::NONE);
+        Bank eagerBank("Eager Bank");
+        Bank lazyBank("Lazy Bank");
+        lazyBank.setInterestMode(Bank::InterestMode::LAZY);
+        vector<string> eagerCustomers, lazyCustomers, eagerNumbers, lazyNumbers;
+        for (size_t i = 0; i < customerCount; ++i) {
+            for (Bank* bank : {&eagerBank, &lazyBank}) {
+                const string owner = bank->createCustomer("Lazy " + to_string(i), "1 Test Rd", "555-0000").getCustomerId();
+                const Account& savings = bank->createSavingsAccount(owner, Money::fromMinorUnits(100000 + 137 * i),
+                                                                    InterestRate::fromPartsPerMillion(1000 + 500 * (i % 40)));
+                const Account& checking = bank->createCheckingAccount(owner, Money::fromMinorUnits(5000), Money::fromDouble(100.00));
+                (bank == &eagerBank ? eagerCustomers : lazyCustomers).push_back(owner);
+                (bank == &eagerBank ? eagerNumbers : lazyNumbers).push_back(savings.getAccountNumber());
+                (bank == &eagerBank ? eagerNumbers : lazyNumbers).push_back(checking.getAccountNumber());
+            }
+        }
+
+        // Only every third account sees postings, so most settle on a read
+        mt19937 postingRng(31);
+        uniform_int_distribution<size_t> pickAccount(0, eagerNumbers.size() / 3 - 1);
+        uniform_int_distribution<int64_t> pickCents(1, 20000);
+        size_t mismatches = 0;
+        auto compareTotals = [&]() {
+            const BalanceAggregates::Totals eager = eagerBank.getBalanceTotals();
+            const BalanceAggregates::Totals lazy = lazyBank.getBalanceTotals();
+            mismatches += (eager.deposits != lazy.deposits || eager.overdraftExposure != lazy.overdraftExposure) ? 1 : 0;
+            for (size_t i = 0; i < customerCount; ++i) {
+                mismatches += (eagerBank.getCustomerNetWorth(eagerCustomers[i]) != lazyBank.getCustomerNetWorth(lazyCustomers[i])) ? 1 : 0;
+            }
+            mismatches += (eagerBank.verifyBalanceTotals() && lazyBank.verifyBalanceTotals()) ? 0 : 1;
+        };
+        auto sameRows = [](const TransactionHistory& a, const TransactionHistory& b) {
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (size_t k = 0; k < a.size(); ++k) {
+                if (a[k].getType() != b[k].getType() || a[k].getAmount() != b[k].getAmount() ||
+                    a[k].getDescription() != b[k].getDescription()) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        for (int month = 0; month < months; ++month) {
+            for (int p = 0; p < 300; ++p) {
+                const size_t index = 3 * pickAccount(postingRng);
+                const Money amount = Money::fromMinorUnits(pickCents(postingRng));
+                const bool deposit = (p % 2 == 0);
+                for (Bank* bank : {&eagerBank, &lazyBank}) {
+                    Account* account = bank->getAccount((bank == &eagerBank ? eagerNumbers : lazyNumbers)[index]);
+                    if (deposit) {
+                        account->deposit(amount, "Lazy check");
+                    } else {
+                        account->withdraw(amount, "Lazy check");
+                    }
+                }
+            }
+            eagerBank.runMonthlyMaintenance();
+            lazyBank.runMonthlyMaintenance();
+            // Alternate which read comes first after a month-end
+            if (month % 2 == 0) {
+                compareTotals();
+            }
+            for (size_t i = 0; i < eagerNumbers.size(); ++i) {
+                const Account& eager = *eagerBank.getAccount(eagerNumbers[i]);
+                const Account& lazy = *lazyBank.getAccount(lazyNumbers[i]);
+                const TransactionHistory eagerLatest = eager.getLatestTransactions(2);
+                const TransactionHistory lazyLatest = lazy.getLatestTransactions(2);
+                const TransactionPage eagerPage = eager.getTransactionsBefore(numeric_limits<long>::max(), 3);
+                const TransactionPage lazyPage = lazy.getTransactionsBefore(numeric_limits<long>::max(), 3);
+                const TransactionHistory eagerAll = eager.getTransactionsBetween(0, numeric_limits<time_t>::max());
+                const TransactionHistory lazyAll = lazy.getTransactionsBetween(0, numeric_limits<time_t>::max());
+                if (!sameRows(eagerLatest, lazyLatest) || !sameRows(eagerPage.transactions, lazyPage.transactions) ||
+                    !sameRows(eagerAll, lazyAll)) {
+                    ++mismatches;
+                }
+            }
+            if (month % 2 != 0) {
+                compareTotals();
+            }
+        }
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+        cout << eagerNumbers.size() << " accounts over " << months << " months, " << mismatches
+             << " mismatches between eager and lazy interest\n";
+        if (mismatches != 0) {
+            cout << "ERROR: lazy interest disagrees with eager interest on history or totals\n";
+            return 1;
+        }
+        cout << "Lazy interest matches eager interest.\n";
+    }
+    printSeparator();
+
+    // 12. Durability check
+    // Mixed operations run on several threads with the write-ahead log on;
+    // replaying the log into an empty Bank must rebuild every account. A
+    // copy of the log cut off inside its last record (a crash mid-write)
+    // replays up to the record before it, and reopening that copy for
+    // writing drops the torn bytes so new records follow on cleanly.
+    cout << "--- Durability Check ---\n";
+    {
+        const string walPath = demoTempPath("durability.wal").string();
+        const string tornPath = walPath + ".torn";
+        remove(walPath.c_str());
+        remove(tornPath.c_str());
+        dataManager.setSink(DataManager::LogSink::NONE);
+        Bank durableBank("Durable Bank");
+        durableBank.enableDurability(walPath, WriteAheadLog::SyncMode::WAIT_FOR_COMMIT);
+        vector<string> numbers;
+        for (size_t i = 0; i < 40; ++i) {
+            const string owner = durableBank.createCustomer("Durable " + to_string(i), "1 Test Rd", "555-0000").getCustomerId();
+            numbers.push_back(durableBank.createSavingsAccount(owner, Money::fromMinorUnits(50000 + 113 * i),
+                                                               InterestRate::fromDouble(0.02)).getAccountNumber());
+            numbers.push_back(durableBank.createCheckingAccount(owner, Money::fromMinorUnits(10000),
+                                                                Money::fromDouble(150.00)).getAccountNumber());
+        }
+
+        durableBank.setThreadSafe(true);
+        vector<thread> durableWorkers;
+        for (unsigned t = 0; t < 4; ++t) {
+            durableWorkers.emplace_back([&, t]() {
+                mt19937 rng(100 + t);
+                uniform_int_distribution<size_t> pickAccount(0, numbers.size() - 1);
+                uniform_int_distribution<int64_t> pickCents(1, 30000);
+                for (int i = 0; i < 600; ++i) {
+                    const Money amount = Money::fromMinorUnits(pickCents(rng));
+                    Account* account = durableBank.getAccount(numbers[pickAccount(rng)]);
+                    if (i % 3 == 0) {
+                        account->deposit(amount, "Durable deposit");
+                    } else if (i % 3 == 1) {
+                        account->withdraw(amount, "Durable withdrawal");
+                    } else {
+                        durableBank.transferFunds(numbers[pickAccount(rng)], numbers[pickAccount(rng)], amount, "Durable transfer");
+                    }
+                }
+            });
+        }
+        for (thread& worker : durableWorkers) {
+            worker.join();
+        }
+        vector<Bank::TransferRequest> durableBatch;
+        for (size_t i = 0; i + 1 < numbers.size(); i += 2) {
+            durableBatch.push_back({numbers[i], numbers[i + 1], Money::fromMinorUnits(777), "Durable batch"});
+        }
+        durableBank.applyTransfers(durableBatch, 4);
+        durableBank.setThreadSafe(false);
+        durableBank.runMonthlyMaintenance();
+        // An account that is opened, used and closed again
+        const string closedOwner = durableBank.createCustomer("Durable closer", "1 Test Rd", "555-0000").getCustomerId();
+        Account& closing = durableBank.createCheckingAccount(closedOwner, Money(), Money());
+        const string closedNumber = closing.getAccountNumber();
+        closing.deposit(Money::fromMinorUnits(2500), "Durable deposit");
+        closing.withdraw(Money::fromMinorUnits(2500), "Durable withdrawal");
+        durableBank.closeAccount(closedNumber);
+        // The last record in the log; the torn copy loses it
+        const Money lastDeposit = Money::fromMinorUnits(4321);
+        durableBank.getAccount(numbers[0])->deposit(lastDeposit, "Last deposit");
+        const uint64_t commits = durableBank.getWriteAheadLog()->getCommitCount();
+        durableBank.disableDurability();
+
+        Bank recoveredBank("Recovered Bank");
+        const size_t replayed = recoveredBank.replayWriteAheadLog(walPath);
+        size_t mismatches = countStateMismatches(durableBank, recoveredBank);
+        mismatches += recoveredBank.verifyBalanceTotals() ? 0 : 1;
+        mismatches += (*recoveredBank.getAccount(closedNumber) == *(InvalidAccount::getInstance())) ? 0 : 1;
+
+        filesystem::copy_file(walPath, tornPath, filesystem::copy_options::overwrite_existing);
+        filesystem::resize_file(tornPath, filesystem::file_size(walPath) - 3);
+        Bank tornBank("Torn Bank");
+        const size_t tornReplayed = tornBank.replayWriteAheadLog(tornPath);
+        bool tornTailOk = tornReplayed + 1 == replayed &&
+                          tornBank.getAccount(numbers[0])->getBalance() == durableBank.getAccount(numbers[0])->getBalance() - lastDeposit;
+        tornBank.enableDurability(tornPath);
+        tornBank.getAccount(numbers[0])->deposit(lastDeposit, "Last deposit");
+        tornBank.disableDurability();
+        Bank reopenedBank("Reopened Bank");
+        tornTailOk = tornTailOk && reopenedBank.replayWriteAheadLog(tornPath) == replayed &&
+                     countStateMismatches(durableBank, reopenedBank) == 0;
+        remove(walPath.c_str());
+        remove(tornPath.c_str());
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+
+        cout << replayed << " records in " << commits << " commits replayed into an empty bank: " << mismatches
+             << " mismatches\n";
+        cout << "Torn tail: " << tornReplayed << " records replayed, " << (tornTailOk ? "recovered" : "NOT recovered") << "\n";
+        if (mismatches != 0 || !tornTailOk) {
+            cout << "ERROR: the write-ahead log did not rebuild the bank\n";
+            return 1;
+        }
+        cout << "Write-ahead log rebuilds the bank.\n";
+    }
+    printSeparator();
+
+    // 13. Snapshot check
+    // A lazy-interest bank is snapshotted while writers keep posting with
+    // the write-ahead log on, then keeps going. Loading the snapshot into an
+    // empty Bank and replaying the log from the position it returns must
+    // give the same accounts, without applying a posting twice. Truncated
+    // or corrupt snapshot files must be refused.
+    cout << "--- Snapshot Check ---\n";
+    {
+        const string walPath = demoTempPath("snapshot.wal").string();
+        const string snapshotPath = demoTempPath("snapshot.snap").string();
+        const string damagedPath = snapshotPath + ".damaged";
+        remove(walPath.c_str());
+        dataManager.setSink(DataManager::LogSink::NONE);
+        Bank liveBank("Live Bank");
+        liveBank.setInterestMode(Bank::InterestMode::LAZY);
+        liveBank.enableDurability(walPath, WriteAheadLog::SyncMode::BACKGROUND);
+        vector<string> numbers;
+        for (size_t i = 0; i < 60; ++i) {
+            const string owner = liveBank.createCustomer("Snapshot " + to_string(i), "1 Test Rd", "555-0000").getCustomerId();
+            numbers.push_back(liveBank.createSavingsAccount(owner, Money::fromMinorUnits(80000 + 71 * i),
+                                                            InterestRate::fromDouble(0.015)).getAccountNumber());
+            numbers.push_back(liveBank.createCheckingAccount(owner, Money::fromMinorUnits(20000),
+                                                             Money::fromDouble(200.00)).getAccountNumber());
+        }
+        liveBank.runMonthlyMaintenance();
+
+        auto runWriters = [&](unsigned seed) {
+            vector<thread> writers;
+            for (unsigned t = 0; t < 4; ++t) {
+                writers.emplace_back([&, t]() {
+                    mt19937 rng(seed + t);
+                    uniform_int_distribution<size_t> pickAccount(0, numbers.size() - 1);
+                    uniform_int_distribution<int64_t> pickCents(1, 30000);
+                    for (int i = 0; i < 3000; ++i) {
+                        const Money amount = Money::fromMinorUnits(pickCents(rng));
+                        if (i % 2 == 0) {
+                            liveBank.getAccount(numbers[pickAccount(rng)])->deposit(amount, "Snapshot deposit");
+                        } else {
+                            liveBank.transferFunds(numbers[pickAccount(rng)], numbers[pickAccount(rng)], amount, "Snapshot transfer");
+                        }
+                    }
+                });
+            }
+            return writers;
+        };
+        liveBank.setThreadSafe(true);
+        vector<thread> writers = runWriters(300);
+        this_thread::sleep_for(chrono::milliseconds(2));
+        const uint64_t snapshotLsn = liveBank.saveSnapshot(snapshotPath);
+        for (thread& writer : writers) {
+            writer.join();
+        }
+        liveBank.setThreadSafe(false);
+        liveBank.runMonthlyMaintenance();
+        liveBank.getAccount(numbers[1])->withdraw(Money::fromMinorUnits(1234), "After snapshot");
+        liveBank.disableDurability();
+
+        Bank restoredBank("Restored Bank");
+        const size_t tailRecords = restoredBank.replayWriteAheadLog(walPath, restoredBank.loadSnapshot(snapshotPath));
+        size_t mismatches = countStateMismatches(liveBank, restoredBank);
+        mismatches += (restoredBank.verifyBalanceTotals() && liveBank.verifyBalanceTotals()) ? 0 : 1;
+
+        // Damaged copies: one missing its last bytes, one with a header count overwritten
+        auto rejected = [&]() {
+            Bank scratchBank("Scratch Bank");
+            try {
+                scratchBank.loadSnapshot(damagedPath);
+            } catch (const runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+        filesystem::copy_file(snapshotPath, damagedPath, filesystem::copy_options::overwrite_existing);
+        filesystem::resize_file(damagedPath, filesystem::file_size(snapshotPath) - 16);
+        bool damagedRejected = rejected();
+        {
+            filesystem::copy_file(snapshotPath, damagedPath, filesystem::copy_options::overwrite_existing);
+            fstream damaged(damagedPath, ios::in | ios::out | ios::binary);
+            const uint64_t hugeCount = 1ull << 40;
+            damaged.seekp(offsetof(BankSnapshot::Header, transactionCount));
+            damaged.write(reinterpret_cast<const char*>(&hugeCount), sizeof(hugeCount));
+        }
+        damagedRejected = rejected() && damagedRejected;
+        remove(walPath.c_str());
+        remove(snapshotPath.c_str());
+        remove(damagedPath.c_str());
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+
+        cout << "Snapshot at WAL position " << snapshotLsn << " plus " << tailRecords << " replayed records: "
+             << mismatches << " mismatches\n";
+        cout << "Truncated and corrupt snapshots " << (damagedRejected ? "refused" : "NOT refused") << "\n";
+        if (mismatches != 0 || !damagedRejected) {
+            cout << "ERROR: snapshot recovery did not rebuild the bank\n";
+            return 1;
+        }
+        cout << "Snapshot plus log tail rebuilds the bank.\n";
+    }
+    printSeparator();
+
+    // 14. Account close and slot reuse check
+    // Closing an account frees its pool slot and the next account of that
+    // type is built in the same place. Lookups that named the closed
+    // account, by number or by handle, must fail rather than reach the new one.
+    cout << "--- Account Close and Reuse Check ---\n";
+    {
+        dataManager.setSink(DataManager::LogSink::NONE);
+        Bank reuseBank("Reuse Bank");
+        const string owner = reuseBank.createCustomer("Reuse Owner", "1 Test Rd", "555-0000").getCustomerId();
+        Account& kept = reuseBank.createCheckingAccount(owner, Money::fromMinorUnits(5000), Money::fromDouble(50.00));
+        Account& closing = reuseBank.createSavingsAccount(owner, Money::fromMinorUnits(1500), InterestRate::fromDouble(0.01));
+        const string closedNumber = closing.getAccountNumber();
+        const Account* closedAddress = &closing;
+        const Bank::AccountHandle closedHandle = reuseBank.getAccountHandle(closedNumber);
+
+        size_t failures = 0;
+        failures += reuseBank.closeAccount(closedNumber) ? 1 : 0; // Still holds money
+        closing.withdraw(Money::fromMinorUnits(1500), "Emptied to close");
+        failures += reuseBank.closeAccount(closedNumber) ? 0 : 1;
+        failures += reuseBank.closeAccount(closedNumber) ? 1 : 0; // Already closed
+
+        Account& replacement = reuseBank.createSavingsAccount(owner, Money::fromMinorUnits(9900), InterestRate::fromDouble(0.02));
+        const bool slotReused = &replacement == closedAddress;
+        const Account& invalid = *(InvalidAccount::getInstance());
+        failures += (*reuseBank.getAccount(closedHandle) == invalid) ? 0 : 1;
+        failures += (*reuseBank.getAccount(closedNumber) == invalid) ? 0 : 1;
+        failures += reuseBank.transferFunds(kept.getAccountNumber(), closedNumber, Money::fromMinorUnits(100), "To a closed account") ? 1 : 0;
+        failures += (reuseBank.getAccount(reuseBank.getAccountHandle(replacement.getAccountNumber())) == &replacement) ? 0 : 1;
+        failures += (reuseBank.getCustomer(owner).getAccounts().size() == 2) ? 0 : 1;
+        failures += (reuseBank.getCustomerNetWorth(owner) == kept.getBalance() + replacement.getBalance()) ? 0 : 1;
+        failures += reuseBank.verifyBalanceTotals() ? 0 : 1;
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+
+        cout << "Closed " << closedNumber << "; " << replacement.getAccountNumber()
+             << (slotReused ? " reuses its slot" : " got a new slot") << ", " << failures << " failed checks\n";
+        if (!slotReused || failures != 0) {
+            cout << "ERROR: a closed account's slot was not reused safely\n";
+            return 1;
+        }
+        cout << "Stale lookups fail after slot reuse.\n";
+    }
+    printSeparator();
+
+    // With only one segment kept in memory, older log entries are read
+    // back from spill files; queries must not be able to tell. A size
+    // limit then deletes the oldest files.
+    cout << "--- Log Spill Check ---\n";
+    {
+        dataManager.setSink(DataManager::LogSink::NONE);
+        Bank spillBank("Spill Bank");
+        const string owner = spillBank.createCustomer("Spill Owner", "2 Test Rd", "555-0001").getCustomerId();
+        Account& savings = spillBank.createSavingsAccount(owner, Money::fromMinorUnits(100000), InterestRate::fromDouble(0.03));
+        Account& checking = spillBank.createCheckingAccount(owner, Money::fromMinorUnits(100000), Money::fromDouble(100.00));
+        for (int i = 0; i < 4 * static_cast<int>(LogStore::SEGMENT_SIZE); ++i) {
+            if (i % 2 == 0) {
+                spillBank.transferFunds(savings.getAccountNumber(), checking.getAccountNumber(), Money::fromMinorUnits(7), "Spill transfer");
+            } else {
+                spillBank.transferFunds(checking.getAccountNumber(), savings.getAccountNumber(), Money::fromMinorUnits(7), "Spill transfer");
+            }
+        }
+        LogQuery checkingInfo;
+        checkingInfo.level = DataLogEntry::LogLevel::INFO;
+        checkingInfo.relatedTo = checking.getAccountNumber();
+        auto render = [](const LogView& view) {
+            vector<string> lines;
+            for (const DataLogEntry& entry : view) {
+                ostringstream line;
+                line << entry;
+                lines.push_back(line.str());
+            }
+            return lines;
+        };
+        const vector<string> savingsInMemory = render(dataManager.getLogsFor(savings.getAccountNumber()));
+        const vector<string> checkingInMemory = render(dataManager.queryLogs(checkingInfo));
+        const size_t retainedInMemory = dataManager.getRetainedLogCount();
+
+        const filesystem::path logDirectory = filesystem::temp_directory_path() / "bankapp-logs";
+        // Only this process's spill directories; other demos may share logDirectory
+        const string ownPrefix = "spill-" + to_string(processId()) + "-";
+        auto spillFiles = [&logDirectory, &ownPrefix](uintmax_t& bytes) {
+            size_t files = 0;
+            bytes = 0;
+            for (const filesystem::directory_entry& store : filesystem::directory_iterator(logDirectory)) {
+                if (!store.is_directory() || store.path().filename().string().compare(0, ownPrefix.size(), ownPrefix) != 0) {
+                    continue;
+                }
+                for (const filesystem::directory_entry& file : filesystem::directory_iterator(store.path())) {
+                    if (file.path().extension() == ".banklog") {
+                        ++files;
+                        bytes += file.file_size();
+                    }
+                }
+            }
+            return files;
+        };
+        LogRetention retention;
+        retention.memorySegments = 1;
+        retention.directory = logDirectory.string();
+        dataManager.setLogRetention(retention);
+        dataManager.flushLogSpills();
+        uintmax_t spilledBytes = 0;
+        const size_t spilledFiles = spillFiles(spilledBytes);
+
+        size_t failures = 0;
+        failures += (render(dataManager.getLogsFor(savings.getAccountNumber())) == savingsInMemory) ? 0 : 1;
+        failures += (render(dataManager.queryLogs(checkingInfo)) == checkingInMemory) ? 0 : 1;
+        failures += (dataManager.getRetainedLogCount() == retainedInMemory) ? 0 : 1;
+        failures += dataManager.getLogsFor("NO-SUCH-ACCOUNT").size() == 0 ? 0 : 1;
+        failures += dataManager.getFailedLogSpillCount() == 0 ? 0 : 1;
+
+        retention.maxDiskBytes = spilledBytes / 2;
+        dataManager.setLogRetention(retention);
+        uintmax_t keptBytes = 0;
+        const size_t keptFiles = spillFiles(keptBytes);
+        failures += (keptFiles < spilledFiles && keptBytes <= retention.maxDiskBytes) ? 0 : 1;
+        failures += dataManager.getRetainedLogCount() < retainedInMemory ? 0 : 1;
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+
+        cout << savingsInMemory.size() << " + " << checkingInMemory.size() << " entries queried from "
+             << spilledFiles << " spill files; " << keptFiles << " kept under a " << retention.maxDiskBytes
+             << "-byte limit, " << failures << " failed checks\n";
+        if (spilledFiles == 0 || failures != 0) {
+            cout << "ERROR: spilled log entries did not match the in-memory ones\n";
+            return 1;
+        }
+        cout << "Spilled log queries match memory.\n";
+    }
+    printSeparator();
+
+    // Statements: for each account, the opening balance plus the period's
+    // rows must give the closing balance, and the opening balance must be
+    // the balance when the period began. Bulk exports must quote and
+    // escape a customer name with a comma, a quote and a control character.
+    cout << "--- Export Check ---\n";
+    {
+        dataManager.setSink(DataManager::LogSink::NONE);
+        Bank exportBank("Export Bank");
+        const string awkwardName = "Ann \"Quote\", Jr\x01";
+        vector<string> customerIds;
+        vector<Account*> accounts;
+        for (int c = 0; c < 4; ++c) {
+            const string id = exportBank.createCustomer(c == 0 ? awkwardName : "Export Customer " + to_string(c),
+                                                        "3 Test Rd", "555-0002").getCustomerId();
+            customerIds.push_back(id);
+            accounts.push_back(&exportBank.createCheckingAccount(id, Money::fromMinorUnits(20000), Money::fromDouble(100.00)));
+            accounts.push_back(&exportBank.createSavingsAccount(id, Money::fromMinorUnits(50000), InterestRate::fromDouble(0.02)));
+        }
+        auto moveMoney = [&exportBank, &accounts](int round) {
+            for (size_t i = 0; i < accounts.size(); ++i) {
+                accounts[i]->deposit(Money::fromMinorUnits(100 + 37 * round), "Export deposit");
+                accounts[i]->withdraw(Money::fromMinorUnits(55 + 11 * round), "Export withdrawal");
+                exportBank.transferFunds(accounts[i]->getAccountNumber(), accounts[(i + 3) % accounts.size()]->getAccountNumber(),
+                                         Money::fromMinorUnits(250 + round), "Export transfer");
+            }
+        };
+        for (int round = 0; round < 3; ++round) {
+            moveMoney(round);
+        }
+        // Rows are stamped in whole seconds, so start the period on the next one
+        const time_t periodStart = time(nullptr) + 1;
+        map<string, int64_t> openingBalances;
+        for (Account* account : accounts) {
+            openingBalances[account->getAccountNumber()] = account->getBalance().getMinorUnits();
+        }
+        while (time(nullptr) < periodStart) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        for (int round = 3; round < 6; ++round) {
+            moveMoney(round);
+        }
+
+        const filesystem::path exportDirectory = demoTempPath("export");
+        StatementExporter::Options options;
+        options.directory = exportDirectory.string();
+        options.from = periodStart;
+        options.workerCount = 2;
+        const StatementExporter::Result statements = StatementExporter(exportBank).run(options);
+
+        // "12.50" or "-0.05" to minor units
+        auto minorUnits = [](string text) {
+            text.erase(remove(text.begin(), text.end(), '.'), text.end());
+            return stoll(text);
+        };
+        size_t failures = (statements.customerCount == customerIds.size() && statements.accountCount == accounts.size()) ? 0 : 1;
+        size_t accountsChecked = 0;
+        for (const string& customerId : customerIds) {
+            ifstream statement(exportDirectory / ("statement-" + customerId + ".txt"));
+            string line, accountNumber;
+            int64_t opening = 0, rowsTotal = 0;
+            while (getline(statement, line)) {
+                if (line.compare(0, 8, "Account ") == 0) {
+                    accountNumber = line.substr(8, line.find(' ', 8) - 8);
+                } else if (line.compare(0, 18, "  Opening balance ") == 0) {
+                    opening = minorUnits(line.substr(18));
+                    rowsTotal = 0;
+                    failures += (opening == openingBalances[accountNumber]) ? 0 : 1;
+                } else if (line.compare(0, 18, "  Closing balance ") == 0) {
+                    const int64_t closing = minorUnits(line.substr(18));
+                    failures += (opening + rowsTotal == closing) ? 0 : 1;
+                    failures += (closing == exportBank.getAccount(accountNumber)->getBalance().getMinorUnits()) ? 0 : 1;
+                    ++accountsChecked;
+                } else if (line.find("  #") != string::npos) {
+                    istringstream row(line.substr(line.find("  #") + 3));
+                    string id, type, amount;
+                    row >> id >> type >> amount;
+                    rowsTotal += minorUnits(amount);
+                }
+            }
+        }
+        failures += (accountsChecked == accounts.size()) ? 0 : 1;
+
+        // The name is the note of the customer's CUSTOMER_CREATED entry
+        auto exported = [&](BulkExporter::Format format, const string& name) {
+            const string path = (exportDirectory / name).string();
+            BulkExporter(format).exportLogs(path, dataManager.getLogsFor(customerIds[0]));
+            ifstream file(path, ios::binary);
+            return string(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        };
+        const string csv = exported(BulkExporter::Format::CSV, "logs.csv");
+        const string jsonl = exported(BulkExporter::Format::JSONL, "logs.jsonl");
+        failures += (csv.find(",\"Ann \"\"Quote\"\", Jr\x01\",") != string::npos) ? 0 : 1;
+        failures += (jsonl.find("\"note\":\"Ann \\\"Quote\\\", Jr\\u0001\"") != string::npos) ? 0 : 1;
+        filesystem::remove_all(exportDirectory);
+        dataManager.setSink(DataManager::LogSink::CONSOLE);
+
+        cout << statements.customerCount << " statements, " << accountsChecked << " accounts reconciled over "
+             << statements.transactionCount << " period rows; " << failures << " failed checks\n";
+        if (failures != 0) {
+            cout << "ERROR: exported statements or log files are wrong\n";
+            return 1;
+        }
+        cout << "Statements balance and exports escape awkward names.\n";
+    }
+    printSeparator();
+
+    cout << "Operation metrics:\n" << dataManager.getMetricsReport();
+    printSeparator();
+
     cout << "--- End of Simulation ---\n";
 
     return 0;